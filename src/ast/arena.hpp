@@ -0,0 +1,136 @@
+/***
+ * @file arena.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Fixed-size array living inside an AstArena
+    template <typename T>
+    class ArenaList {
+    public:
+        T* items;
+        uint32_t count;
+
+        ArenaList() : items(nullptr), count(0) {}
+        ArenaList(T* items, uint32_t count) : items(items), count(count) {}
+
+        T* begin() const { return this->items; }
+        T* end() const { return this->items + this->count; }
+        size_t size() const { return this->count; }
+        bool empty() const { return this->count == 0; }
+        T& operator[](size_t index) const { return this->items[index]; }
+    };
+
+    // Bump-pointer allocator owning every node of a compilation unit,
+    // the whole tree is released at once when the arena goes away
+    class AstArena {
+    private:
+        static constexpr size_t BlockSize = 64 * 1024;
+
+        struct Block {
+            unique_ptr<byte[]> data;
+            size_t size;
+        };
+
+        struct Destructor {
+            void* object;
+            void (*destroy)(void*);
+        };
+
+        vector<Block> blocks;
+        vector<Destructor> destructors;
+        byte* cursor = nullptr;
+        byte* limit = nullptr;
+
+        void* allocate(size_t size, size_t align) {
+            auto address = reinterpret_cast<uintptr_t>(this->cursor);
+            auto aligned = (address + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+
+            if (!this->cursor || aligned + size > reinterpret_cast<uintptr_t>(this->limit)) {
+                size_t blockSize = max(BlockSize, size + align);
+                this->blocks.push_back({make_unique<byte[]>(blockSize), blockSize});
+
+                this->cursor = this->blocks.back().data.get();
+                this->limit = this->cursor + blockSize;
+
+                address = reinterpret_cast<uintptr_t>(this->cursor);
+                aligned = (address + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+            }
+
+            this->cursor = reinterpret_cast<byte*>(aligned + size);
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        template <typename T>
+        void track(T* object) {
+            if constexpr (!is_trivially_destructible_v<T>) {
+                this->destructors.push_back({object, [](void* pointer) { static_cast<T*>(pointer)->~T(); }});
+            }
+        }
+
+    public:
+        AstArena() = default;
+        AstArena(const AstArena&) = delete;
+        AstArena& operator=(const AstArena&) = delete;
+
+        ~AstArena() {
+            for (auto it = this->destructors.rbegin(); it != this->destructors.rend(); ++it) {
+                it->destroy(it->object);
+            }
+        }
+
+        // Takes over everything `other` allocated, its nodes stay valid and die with this arena
+        void adopt(AstArena&& other) {
+            for (auto& block : other.blocks) {
+                this->blocks.push_back(move(block));
+            }
+            this->destructors.insert(this->destructors.end(), other.destructors.begin(), other.destructors.end());
+
+            other.blocks.clear();
+            other.destructors.clear();
+            other.cursor = nullptr;
+            other.limit = nullptr;
+        }
+
+        template <typename T, typename... Args>
+        T* make(Args&&... args) {
+            T* object = new (this->allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+            this->track(object);
+            return object;
+        }
+
+        template <typename T>
+        ArenaList<T> list(const vector<T>& values) {
+            if (values.empty()) return ArenaList<T>();
+
+            T* items = static_cast<T*>(this->allocate(sizeof(T) * values.size(), alignof(T)));
+            for (size_t i = 0; i < values.size(); i++) {
+                this->track(new (items + i) T(values[i]));
+            }
+
+            return ArenaList<T>(items, static_cast<uint32_t>(values.size()));
+        }
+    };
+
+}
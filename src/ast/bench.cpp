@@ -0,0 +1,284 @@
+/***
+ * @file bench.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "bench.hpp"
+#include "flat.hpp"
+#include "incremental.hpp"
+#include "parser.hpp"
+#include "parallel.hpp"
+#include "sema.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+
+    // Each function calls the one before it, so a signature change breaks a caller
+    static string generateUnit(size_t functions) {
+        string source;
+
+        for (size_t n = 0; n < functions; n++) {
+            string id = to_string(n);
+            string callee = to_string(n > 0 ? n - 1 : 0);
+
+            source += "func f" + id + "(a: int, b: int): int {\n";
+            source += "   var x: int = a * " + id + " + b;\n";
+            source += "   return x + f" + callee + "(a, b);\n";
+            source += "}\n\n";
+        }
+
+        return source;
+    }
+
+    // Tree with types and every node position, enough to tell two parses apart
+    static string treeText(const BlockStmt* block) {
+        FlatAst flat(block);
+        string result = flat.debug(flat.root);
+
+        for (const auto& pos : flat.positions) result += to_string(pos.offset) + ",";
+        return result;
+    }
+
+    struct Snapshot {
+        string tree;
+        vector<string> diagnostics;
+    };
+
+    static Snapshot snapshot(const IncrementalUnit& unit, const SourceManager& sources) {
+        Snapshot result {treeText(unit.tree()), {}};
+
+        for (const auto& error : unit.diagnostics()) result.diagnostics.push_back(error.format(&sources));
+        return result;
+    }
+
+    // Points cout and cerr at strings while alive
+    class CapturedOutput {
+    private:
+        ostringstream out;
+        ostringstream err;
+        streambuf* outBuffer;
+        streambuf* errBuffer;
+
+    public:
+        CapturedOutput() : outBuffer(cout.rdbuf(this->out.rdbuf())), errBuffer(cerr.rdbuf(this->err.rdbuf())) {}
+
+        ~CapturedOutput() {
+            cout.rdbuf(this->outBuffer);
+            cerr.rdbuf(this->errBuffer);
+        }
+
+        string errors() const { return this->err.str(); }
+    };
+
+    // `text` the way the batch compiler sees it: sequential parseCode, Sema::check and FlatAst,
+    // none of IncrementalUnit's splitting, reuse or position shifting. `parsed` is false when
+    // parsing failed, the snapshot only holds the parse errors then
+    static Snapshot referenceSnapshot(const string& text, bool& parsed) {
+        SourceManager sources;
+        FileId file = sources.addBuffer("bench-edit.sun", text);
+        AstArena arena;
+        Parser parser(sources);
+        BlockStmt* block = nullptr;
+        string errors;
+
+        // Both print their diagnostics and throw on errors
+        {
+            CapturedOutput output;
+
+            try {
+                block = parser.parseCode(file, arena);
+                Sema(sources).check(block);
+            } catch (const runtime_error&) {}
+
+            errors = output.errors();
+        }
+
+        Snapshot result;
+        parsed = block != nullptr;
+        if (parsed) result.tree = treeText(block);
+
+        istringstream lines(errors);
+        for (string line; getline(lines, line);) result.diagnostics.push_back(line);
+
+        return result;
+    }
+
+    // Milliseconds of the fastest of `runs` parses of `file`, `tree` gets the last tree with its positions
+    static double timeParse(const SourceManager& sources, FileId file, bool parallel, bool lazy, size_t runs, string& tree) {
+        double best = 0;
+
+        for (size_t run = 0; run < runs; run++) {
+            AstArena arena;
+            Parser parser(sources, lazy);
+
+            auto start = chrono::steady_clock::now();
+            BlockStmt* block = parser.parseCode(file, arena, parallel);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            best = run == 0 ? ms : min(best, ms);
+
+            tree = treeText(block);
+        }
+
+        return best;
+    }
+
+    class EditBench {
+    private:
+        ostream& out;
+        SourceManager sources;
+        IncrementalUnit unit;
+        vector<double> keystrokes;
+        size_t mismatches = 0;
+
+        string_view text() const {
+            return this->sources.getBuffer(this->unit.getFile());
+        }
+
+        uint32_t find(string_view needle, uint32_t from = 0) const {
+            return static_cast<uint32_t>(this->text().find(needle, from));
+        }
+
+        // Milliseconds from the edit to its diagnostics, checked against a batch compile afterwards
+        double apply(const TextEdit& change) {
+            auto start = chrono::steady_clock::now();
+            this->unit.edit(change);
+            size_t diagnostics = this->unit.diagnostics().size();
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            // Sequential and incremental recovery can differ after a syntax error, only the first one has to agree
+            bool parsed = false;
+            Snapshot expected = referenceSnapshot(string(this->text()), parsed);
+            Snapshot actual = snapshot(this->unit, this->sources);
+
+            bool same = parsed ? actual.tree == expected.tree && actual.diagnostics == expected.diagnostics
+                : !actual.diagnostics.empty() && !expected.diagnostics.empty() && actual.diagnostics[0] == expected.diagnostics[0];
+
+            if (!same) {
+                this->mismatches++;
+                this->out << "[edit] mismatch after replacing " << change.begin << ".." << change.end << " with \"" << change.text
+                    << "\" (" << diagnostics << " diagnostics)" << endl;
+            }
+
+            return ms;
+        }
+
+    public:
+        EditBench(ostream& out, size_t functions) : out(out), unit(this->sources, "bench-edit.sun", generateUnit(functions)) {}
+
+        // Replaces [begin, end) with `replacement`, then puts the old text back
+        void scenario(const char* name, uint32_t begin, uint32_t end, const string& replacement) {
+            string old(this->text().substr(begin, end - begin));
+
+            double editMs = this->apply({begin, end, replacement});
+            size_t diagnostics = this->unit.diagnostics().size();
+            double revertMs = this->apply({begin, static_cast<uint32_t>(begin + replacement.size()), old});
+
+            char line[160];
+            snprintf(line, sizeof(line), "[edit] %-18s %8.3f ms (%zu diagnostics)  revert %8.3f ms", name, editMs, diagnostics, revertMs);
+            this->out << line << endl;
+        }
+
+        // Types `typed` one character at a time at `at`, then deletes it the same way
+        void typing(uint32_t at, const string& typed) {
+            for (size_t i = 0; i < typed.size(); i++) {
+                this->keystrokes.push_back(this->apply({static_cast<uint32_t>(at + i), static_cast<uint32_t>(at + i), typed.substr(i, 1)}));
+            }
+            for (size_t i = typed.size(); i > 0; i--) {
+                this->keystrokes.push_back(this->apply({static_cast<uint32_t>(at + i - 1), static_cast<uint32_t>(at + i), ""}));
+            }
+        }
+
+        bool run(size_t functions, double budgetMs) {
+            size_t lines = static_cast<size_t>(count(this->text().begin(), this->text().end(), '\n'));
+            this->out << "[edit] " << functions << " functions, " << lines << " lines" << endl;
+
+            string middle = "func f" + to_string(functions / 2) + "(";
+            uint32_t func = this->find(middle);
+            uint32_t body = this->find("a * ", func) + 4;
+            uint32_t param = this->find("b: int", func) + 3;
+            uint32_t name = func + 5;
+
+            this->typing(body, "12345");
+            this->scenario("body type error", body, body, "2.5d + ");
+            this->scenario("gap function", func, func, "func added(q: int): int {\n   return q;\n}\n\n");
+            this->scenario("gap variable", func, func, "var top: int = 1;\n\n");
+            this->scenario("signature", param, param + 3, "bool");
+            this->scenario("rename", name, name + 1, "g");
+            this->scenario("open brace", body, body, "{");
+            this->scenario("remove function", func, this->find("func", func + 1), "");
+
+            sort(this->keystrokes.begin(), this->keystrokes.end());
+            double median = this->keystrokes[this->keystrokes.size() / 2];
+            double worst = this->keystrokes.back();
+
+            char line[160];
+            snprintf(line, sizeof(line), "[edit] %zu keystrokes  median %.3f ms  worst %.3f ms  budget %.1f ms", this->keystrokes.size(), median, worst, budgetMs);
+            this->out << line << endl;
+
+            if (worst > budgetMs) this->out << "[edit] keystroke over budget" << endl;
+            if (this->mismatches) this->out << "[edit] " << this->mismatches << " edits diverged from a full rebuild" << endl;
+
+            return worst <= budgetMs && this->mismatches == 0;
+        }
+    };
+
+    // Benchmark //
+    bool benchmarkEdits(ostream& out, size_t functions, double budgetMs) {
+        EditBench bench(out, max<size_t>(functions, 2));
+        return bench.run(max<size_t>(functions, 2), budgetMs);
+    }
+
+    bool benchmarkParse(ostream& out, size_t functions) {
+        SourceManager sources;
+        FileId file = sources.addBuffer("bench-parse.sun", generateUnit(max<size_t>(functions, 2)));
+        size_t mismatches = 0;
+        char line[160];
+
+        snprintf(line, sizeof(line), "[parse] %zu functions, %.1f MB, %u hardware threads", functions,
+            sources.getBuffer(file).size() / 1048576.0, thread::hardware_concurrency());
+        out << line << endl;
+
+        for (bool lazy : {false, true}) {
+            const char* mode = lazy ? "lazy" : "eager";
+            string expected, tree;
+
+            double sequentialMs = timeParse(sources, file, false, lazy, 3, expected);
+            snprintf(line, sizeof(line), "[parse] %-5s sequential   %9.2f ms", mode, sequentialMs);
+            out << line << endl;
+
+            for (size_t threads = 1; threads <= 8; threads *= 2) {
+                workerOverride() = threads;
+                double ms = timeParse(sources, file, true, lazy, 3, tree);
+                workerOverride() = 0;
+
+                bool same = tree == expected;
+                if (!same) mismatches++;
+
+                snprintf(line, sizeof(line), "[parse] %-5s %zu thread%s    %9.2f ms  (%.2fx)%s", mode, threads, threads == 1 ? " " : "s",
+                    ms, sequentialMs / ms, same ? "" : "  tree differs from the sequential parse");
+                out << line << endl;
+            }
+        }
+
+        return mismatches == 0;
+    }
+
+}
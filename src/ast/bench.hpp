@@ -0,0 +1,35 @@
+/***
+ * @file bench.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <cstddef>
+#include <ostream>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Edits a generated file of `functions` five-line functions through an IncrementalUnit and
+    // times each edit up to its diagnostics: keystrokes in a body, declarations added in the gaps,
+    // signature changes, renames, broken braces, each followed by its revert. After every edit
+    // the tree, its positions and the diagnostics have to match a batch compile of the same text
+    // (parseCode, Sema::check, FlatAst), only the first error when it does not parse.
+    // False on a mismatch, or when the slowest keystroke goes over `budgetMs`
+    bool benchmarkEdits(ostream& out, size_t functions = 4000, double budgetMs = 10);
+
+    // Parses a generated file of `functions` functions sequentially, then in parallel with 1, 2,
+    // 4 and 8 threads, eagerly and with lazy bodies. Every parallel tree has to match the
+    // sequential one. False on a mismatch
+    bool benchmarkParse(ostream& out, size_t functions = 20000);
+
+}
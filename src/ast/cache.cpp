@@ -0,0 +1,680 @@
+/***
+ * @file cache.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "cache.hpp"
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    struct AstImageHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint64_t sourceSize;
+
+        uint32_t symbols;
+        uint32_t symbolBytes;
+        uint32_t types;
+        uint32_t typeWords;
+        uint64_t nodeBytes;
+        uint64_t payloadHash; // hashSource of every byte after the header
+    };
+
+    // Node stream, one record per node in pre-order. Numbers are LEB128 varints, `delta` is the
+    // zigzag offset from the previous node's position, `sym`/`type` index the local tables:
+    //
+    //   every node      kind u8, delta, and for expressions its type
+    //   BlockStmt       count, statements
+    //   FuncStmt        sym name, type return, exported u8, count, { sym name, type }..., count, statements
+    //   ReturnStmt      value
+    //   VarDecStmt      sym name, type declared, hasValue u8, value?
+    //   BoolExpr        u8    IntExpr    zigzag    CharExpr    u8
+    //   FloatExpr       raw 4 bytes                DoubleExpr  raw 8 bytes
+    //   IdentExpr       sym
+    //   CallExpr        isExpr u8, callee, count, args
+    //   UnaryExpr       op u8, value
+    //   AssignmentExpr  sym target, value
+    //   Binary/Logical/ComparasonExpr  op u8, left, right
+
+    // Helpers //
+    static size_t align8(size_t size) {
+        return (size + 7) & ~static_cast<size_t>(7);
+    }
+
+    static unsigned long processId() {
+#ifdef _WIN32
+        return static_cast<unsigned long>(_getpid());
+#else
+        return static_cast<unsigned long>(getpid());
+#endif
+    }
+
+    uint64_t hashSource(string_view source) {
+        uint64_t hash = 0xcbf29ce484222325;
+
+        for (unsigned char c : source) {
+            hash ^= c;
+            hash *= 0x100000001b3;
+        }
+
+        return hash;
+    }
+
+    // Writing //
+    class ImageWriter {
+    private:
+        unordered_map<Symbol, uint32_t> symbolIds;
+        unordered_map<TypeId, uint32_t> typeIds;
+        uint32_t lastOffset = 0;
+
+        void byte(uint8_t value) {
+            this->nodes.push_back(static_cast<char>(value));
+        }
+
+        void varint(uint64_t value) {
+            while (value >= 0x80) {
+                this->byte(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            this->byte(static_cast<uint8_t>(value));
+        }
+
+        void zigzag(int64_t value) {
+            this->varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        template <typename T>
+        void raw(T value) {
+            this->nodes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        uint32_t symbol(Symbol symbol) {
+            auto [it, inserted] = this->symbolIds.emplace(symbol, static_cast<uint32_t>(this->symbolList.size()));
+            if (inserted) this->symbolList.push_back(symbol);
+
+            return it->second;
+        }
+
+        uint32_t type(TypeId id) {
+            auto it = this->typeIds.find(id);
+            if (it != this->typeIds.end()) return it->second;
+
+            const TypeInfo& info = typeTable().get(id);
+            auto list = [this](const vector<TypeId>& types) {
+                vector<uint32_t> local;
+                for (TypeId type : types) local.push_back(this->type(type));
+                return local;
+            };
+
+            vector<uint32_t> generics = list(info.generics);
+            vector<vector<uint32_t>> unsizedGenerics;
+            for (const auto& types : info.unsizedGenerics) unsizedGenerics.push_back(list(types));
+            vector<uint32_t> parents = list(info.parents);
+
+            auto words = [this](const vector<uint32_t>& values) {
+                this->typeWords.push_back(static_cast<uint32_t>(values.size()));
+                this->typeWords.insert(this->typeWords.end(), values.begin(), values.end());
+            };
+
+            this->typeWords.push_back(static_cast<uint32_t>(info.kind));
+            this->typeWords.push_back(info.extra == InvalidSymbol ? UINT32_MAX : this->symbol(info.extra));
+            this->typeWords.push_back(info.isPointer);
+            words(generics);
+            this->typeWords.push_back(static_cast<uint32_t>(unsizedGenerics.size()));
+            for (const auto& types : unsizedGenerics) words(types);
+            words(parents);
+
+            uint32_t local = static_cast<uint32_t>(this->typeIds.size());
+            this->typeIds.emplace(id, local);
+            return local;
+        }
+
+        void statements(const ArenaList<StmtPtr>& list) {
+            this->varint(list.size());
+            for (auto stmt : list) this->node(stmt);
+        }
+
+    public:
+        vector<Symbol> symbolList;
+        vector<uint32_t> typeWords;
+        string nodes;
+
+        size_t typeCount() const { return this->typeIds.size(); }
+
+        void node(const Stmt* node) {
+            NodeType kind = node->getKind();
+
+            this->byte(static_cast<uint8_t>(kind));
+            this->zigzag(static_cast<int64_t>(node->pos.offset) - this->lastOffset);
+            this->lastOffset = node->pos.offset;
+
+            // Statements come first in NodeType
+            if (kind >= NodeType::NullExpr) {
+                this->varint(this->type(static_cast<const Expr*>(node)->type_));
+            }
+
+            switch (kind) {
+                case NodeType::BlockStmt: this->statements(static_cast<const BlockStmt*>(node)->body); break;
+                case NodeType::FuncStmt: {
+                    auto func = static_cast<const FuncStmt*>(node);
+                    this->varint(this->symbol(func->identifier));
+                    this->varint(this->type(func->returnType));
+                    this->byte(func->exported);
+
+                    this->varint(func->args.size());
+                    for (const auto& [name, type] : func->args) {
+                        this->varint(this->symbol(name));
+                        this->varint(this->type(type));
+                    }
+
+                    this->statements(func->body);
+                    break;
+                }
+                case NodeType::ReturnStmt: this->node(static_cast<const ReturnStmt*>(node)->ret); break;
+                case NodeType::VarDecStmt: {
+                    auto varDec = static_cast<const VarDecStmt*>(node);
+                    this->varint(this->symbol(varDec->identifier));
+                    this->varint(this->type(varDec->type));
+                    this->byte(varDec->value != nullptr);
+
+                    if (varDec->value) this->node(varDec->value);
+                    break;
+                }
+
+                case NodeType::NullExpr: break;
+                case NodeType::BoolExpr: this->byte(static_cast<const BoolExpr*>(node)->value); break;
+                case NodeType::IntExpr: this->zigzag(static_cast<const IntExpr*>(node)->value); break;
+                case NodeType::CharExpr: this->byte(static_cast<uint8_t>(static_cast<const CharExpr*>(node)->value)); break;
+                case NodeType::FloatExpr: this->raw(static_cast<const FloatExpr*>(node)->value); break;
+                case NodeType::DoubleExpr: this->raw(static_cast<const DoubleExpr*>(node)->value); break;
+                case NodeType::IdentExpr: this->varint(this->symbol(static_cast<const IdentExpr*>(node)->value)); break;
+
+                case NodeType::CallExpr: {
+                    auto call = static_cast<const CallExpr*>(node);
+                    this->byte(call->isExpr);
+                    this->node(call->left);
+
+                    this->varint(call->args.size());
+                    for (auto arg : call->args) this->node(arg);
+                    break;
+                }
+                case NodeType::UnaryExpr: {
+                    auto unary = static_cast<const UnaryExpr*>(node);
+                    this->byte(static_cast<uint8_t>(unary->op));
+                    this->node(unary->value);
+                    break;
+                }
+                case NodeType::AssignmentExpr: {
+                    auto assign = static_cast<const AssignmentExpr*>(node);
+                    this->varint(this->symbol(assign->identifier));
+                    this->node(assign->value);
+                    break;
+                }
+                case NodeType::BinaryExpr: {
+                    auto binary = static_cast<const BinaryExpr*>(node);
+                    this->byte(static_cast<uint8_t>(binary->op));
+                    this->node(binary->left);
+                    this->node(binary->right);
+                    break;
+                }
+                case NodeType::LogicalExpr: {
+                    auto logical = static_cast<const LogicalExpr*>(node);
+                    this->byte(static_cast<uint8_t>(logical->op));
+                    this->node(logical->left);
+                    this->node(logical->right);
+                    break;
+                }
+                case NodeType::ComparasonExpr: {
+                    auto compare = static_cast<const ComparasonExpr*>(node);
+                    this->byte(static_cast<uint8_t>(compare->op));
+                    this->node(compare->left);
+                    this->node(compare->right);
+                    break;
+                }
+            }
+        }
+    };
+
+    string writeAstImage(const BlockStmt* block, uint64_t sourceHash, uint64_t sourceSize) {
+        ImageWriter writer;
+        writer.node(block);
+
+        vector<uint32_t> symbolStarts {0};
+        string symbolBytes;
+        for (Symbol symbol : writer.symbolList) {
+            symbolBytes += symbols().name(symbol);
+            symbolStarts.push_back(static_cast<uint32_t>(symbolBytes.size()));
+        }
+
+        AstImageHeader header {};
+        header.magic = AstImageMagic;
+        header.version = AstImageVersion;
+        header.sourceHash = sourceHash;
+        header.sourceSize = sourceSize;
+        header.symbols = static_cast<uint32_t>(writer.symbolList.size());
+        header.symbolBytes = static_cast<uint32_t>(symbolBytes.size());
+        header.types = static_cast<uint32_t>(writer.typeCount());
+        header.typeWords = static_cast<uint32_t>(writer.typeWords.size());
+        header.nodeBytes = writer.nodes.size();
+
+        string image;
+        auto section = [&image](const void* data, size_t size) {
+            image.append(static_cast<const char*>(data), size);
+            image.resize(align8(image.size()), '\0');
+        };
+
+        section(&header, sizeof(header));
+        section(symbolStarts.data(), symbolStarts.size() * sizeof(uint32_t));
+        section(symbolBytes.data(), symbolBytes.size());
+        section(writer.typeWords.data(), writer.typeWords.size() * sizeof(uint32_t));
+        section(writer.nodes.data(), writer.nodes.size());
+
+        header.payloadHash = hashSource(string_view(image).substr(align8(sizeof(header))));
+        memcpy(image.data(), &header, sizeof(header));
+
+        return image;
+    }
+
+    // Reading //
+
+    // Every read is bounds checked; past the end or on a bad index `failed` is set and
+    // zeros come back, so a damaged image unwinds to a null tree instead of crashing
+    class ImageReader {
+    private:
+        const uint8_t* cursor;
+        const uint8_t* end;
+        FileId file;
+        AstArena& arena;
+        uint32_t lastOffset = 0;
+
+        uint8_t byte() {
+            if (this->cursor == this->end) {
+                this->failed = true;
+                return 0;
+            }
+
+            return *this->cursor++;
+        }
+
+        uint64_t varint() {
+            uint64_t value = 0;
+
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                uint8_t part = this->byte();
+                value |= static_cast<uint64_t>(part & 0x7f) << shift;
+
+                if (!(part & 0x80)) return value;
+            }
+
+            this->failed = true;
+            return 0;
+        }
+
+        int64_t zigzag() {
+            uint64_t value = this->varint();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        template <typename T>
+        T raw() {
+            T value {};
+
+            if (static_cast<size_t>(this->end - this->cursor) < sizeof(T)) {
+                this->failed = true;
+                return value;
+            }
+
+            memcpy(&value, this->cursor, sizeof(T));
+            this->cursor += sizeof(T);
+            return value;
+        }
+
+        Symbol symbol() {
+            uint64_t local = this->varint();
+            if (local < this->symbols.size()) return this->symbols[local];
+
+            this->failed = true;
+            return InvalidSymbol;
+        }
+
+        TypeId type() {
+            uint64_t local = this->varint();
+            if (local < this->types.size()) return this->types[local];
+
+            this->failed = true;
+            return PrimaryTypeId(TypeEnum::Unknow);
+        }
+
+        OpCode op() {
+            uint8_t value = this->byte();
+            if (value < OpCodeCount) return static_cast<OpCode>(value);
+
+            this->failed = true;
+            return OpCode::Add;
+        }
+
+        // Counts are bounded by the bytes left, each element takes at least two
+        size_t count() {
+            uint64_t value = this->varint();
+            if (value <= static_cast<uint64_t>(this->end - this->cursor) / 2) return static_cast<size_t>(value);
+
+            this->failed = true;
+            return 0;
+        }
+
+        ExprPtr expr() {
+            StmtPtr stmt = this->node();
+            if (!stmt || stmt->getKind() >= NodeType::NullExpr) return static_cast<ExprPtr>(stmt);
+
+            this->failed = true;
+            return nullptr;
+        }
+
+        ArenaList<StmtPtr> statements() {
+            vector<StmtPtr> list(this->count());
+            for (auto& stmt : list) stmt = this->node();
+
+            return this->arena.list(list);
+        }
+
+    public:
+        vector<Symbol> symbols;
+        vector<TypeId> types;
+        bool failed = false;
+
+        ImageReader(string_view nodes, FileId file, AstArena& arena)
+            : cursor(reinterpret_cast<const uint8_t*>(nodes.data())), end(cursor + nodes.size()), file(file), arena(arena) {}
+
+        StmtPtr node() {
+            uint8_t kindByte = this->byte();
+            if (this->failed || kindByte > static_cast<uint8_t>(NodeType::ComparasonExpr)) {
+                this->failed = true;
+                return nullptr;
+            }
+
+            auto kind = static_cast<NodeType>(kindByte);
+            this->lastOffset = static_cast<uint32_t>(this->lastOffset + this->zigzag());
+            TokenPos pos {this->file, this->lastOffset};
+
+            TypeId type = kind >= NodeType::NullExpr ? this->type() : PrimaryTypeId(TypeEnum::Unknow);
+            Expr* expr = nullptr;
+
+            switch (kind) {
+                case NodeType::BlockStmt: {
+                    auto body = this->statements();
+                    if (this->failed) return nullptr;
+
+                    return this->arena.make<BlockStmt>(pos, body);
+                }
+                case NodeType::FuncStmt: {
+                    Symbol name = this->symbol();
+                    TypeId returnType = this->type();
+                    bool exported = this->byte() != 0;
+
+                    vector<pair<Symbol, TypeId>> args(this->count());
+                    for (auto& arg : args) {
+                        arg.first = this->symbol();
+                        arg.second = this->type();
+                    }
+
+                    auto body = this->statements();
+                    if (this->failed) return nullptr;
+
+                    auto func = this->arena.make<FuncStmt>(pos, name, body, this->arena.list(args), returnType);
+                    func->exported = exported;
+                    return func;
+                }
+                case NodeType::ReturnStmt: {
+                    ExprPtr value = this->expr();
+                    if (this->failed) return nullptr;
+
+                    return this->arena.make<ReturnStmt>(pos, value);
+                }
+                case NodeType::VarDecStmt: {
+                    Symbol name = this->symbol();
+                    TypeId declared = this->type();
+                    ExprPtr value = this->byte() ? this->expr() : nullptr;
+                    if (this->failed) return nullptr;
+
+                    return this->arena.make<VarDecStmt>(pos, name, declared, value);
+                }
+
+                case NodeType::NullExpr: expr = this->arena.make<NullExpr>(pos); break;
+                case NodeType::BoolExpr: expr = this->arena.make<BoolExpr>(pos, this->byte() != 0); break;
+                case NodeType::IntExpr: expr = this->arena.make<IntExpr>(pos, static_cast<int>(this->zigzag())); break;
+                case NodeType::CharExpr: expr = this->arena.make<CharExpr>(pos, static_cast<char>(this->byte())); break;
+                case NodeType::FloatExpr: expr = this->arena.make<FloatExpr>(pos, this->raw<float>()); break;
+                case NodeType::DoubleExpr: expr = this->arena.make<DoubleExpr>(pos, this->raw<double>()); break;
+                case NodeType::IdentExpr: expr = this->arena.make<IdentExpr>(pos, type, this->symbol()); break;
+
+                case NodeType::CallExpr: {
+                    bool isExpr = this->byte() != 0;
+                    ExprPtr left = this->expr();
+
+                    vector<ExprPtr> args(this->count());
+                    for (auto& arg : args) arg = this->expr();
+                    if (this->failed) return nullptr;
+
+                    expr = this->arena.make<CallExpr>(pos, type, left, this->arena.list(args), isExpr);
+                    break;
+                }
+                case NodeType::UnaryExpr: {
+                    OpCode op = this->op();
+                    ExprPtr value = this->expr();
+                    if (this->failed) return nullptr;
+
+                    expr = this->arena.make<UnaryExpr>(pos, op, value);
+                    break;
+                }
+                case NodeType::AssignmentExpr: {
+                    Symbol name = this->symbol();
+                    ExprPtr value = this->expr();
+                    if (this->failed) return nullptr;
+
+                    expr = this->arena.make<AssignmentExpr>(pos, name, value);
+                    break;
+                }
+                case NodeType::BinaryExpr:
+                case NodeType::LogicalExpr:
+                case NodeType::ComparasonExpr: {
+                    OpCode op = this->op();
+                    ExprPtr left = this->expr();
+                    ExprPtr right = this->expr();
+                    if (this->failed) return nullptr;
+
+                    if (kind == NodeType::BinaryExpr) expr = this->arena.make<BinaryExpr>(pos, left, op, right);
+                    else if (kind == NodeType::LogicalExpr) expr = this->arena.make<LogicalExpr>(pos, left, op, right);
+                    else expr = this->arena.make<ComparasonExpr>(pos, left, op, right);
+                    break;
+                }
+            }
+
+            // Constructors pick a default type, keep the one that was written
+            expr->type_ = type;
+            return expr;
+        }
+
+        bool atEnd() const {
+            return this->cursor == this->end;
+        }
+    };
+
+    BlockStmt* readAstImage(string_view image, uint64_t sourceHash, uint64_t sourceSize, FileId file, AstArena& arena) {
+        size_t offset = 0;
+        auto section = [&](size_t size) {
+            if (offset > image.size() || size > image.size() - offset) return string_view();
+
+            string_view bytes = image.substr(offset, size);
+            offset += align8(size);
+            return bytes;
+        };
+
+        AstImageHeader header;
+        if (image.size() < sizeof(header)) return nullptr;
+
+        memcpy(&header, section(sizeof(header)).data(), sizeof(header));
+        if (header.magic != AstImageMagic || header.version != AstImageVersion) return nullptr;
+        if (header.sourceHash != sourceHash || header.sourceSize != sourceSize) return nullptr;
+
+        // Every section has to be whole and the last one has to end the image
+        size_t startsSize = (header.symbols + size_t(1)) * sizeof(uint32_t);
+        size_t typeWordsSize = header.typeWords * sizeof(uint32_t);
+
+        string_view payload = image.substr(offset);
+        string_view starts = section(startsSize);
+        string_view symbolBytes = section(header.symbolBytes);
+        string_view typeWords = section(typeWordsSize);
+        string_view nodes = section(header.nodeBytes);
+
+        if (starts.size() != startsSize || symbolBytes.size() != header.symbolBytes || typeWords.size() != typeWordsSize) return nullptr;
+        if (nodes.size() != header.nodeBytes || offset != image.size()) return nullptr;
+
+        // A flipped byte in the node stream can still decode, as a different program
+        if (hashSource(payload) != header.payloadHash) return nullptr;
+
+        ImageReader reader(nodes, file, arena);
+        auto word = [](string_view words, size_t index) {
+            uint32_t value;
+            memcpy(&value, words.data() + index * sizeof(uint32_t), sizeof(value));
+            return value;
+        };
+
+        // Symbols and types back into the shared tables
+        for (size_t i = 0; i < header.symbols; i++) {
+            uint32_t first = word(starts, i);
+            uint32_t last = word(starts, i + 1);
+            if (first > last || last > symbolBytes.size()) return nullptr;
+
+            reader.symbols.push_back(symbols().intern(symbolBytes.substr(first, last - first)));
+        }
+
+        size_t next = 0;
+        bool damaged = false;
+        auto take = [&]() {
+            if (next < header.typeWords) return word(typeWords, next++);
+
+            damaged = true;
+            return uint32_t(0);
+        };
+        auto list = [&](vector<TypeId>& types) {
+            uint32_t count = take();
+
+            for (uint32_t i = 0; i < count && !damaged; i++) {
+                uint32_t local = take();
+
+                if (local < reader.types.size()) types.push_back(reader.types[local]);
+                else damaged = true;
+            }
+        };
+
+        for (size_t i = 0; i < header.types && !damaged; i++) {
+            TypeInfo info;
+            uint32_t kind = take();
+            uint32_t extra = take();
+
+            info.kind = static_cast<TypeEnum>(kind);
+            info.isPointer = take() != 0;
+            list(info.generics);
+
+            uint32_t unsizedCount = take();
+            for (uint32_t j = 0; j < unsizedCount && !damaged; j++) {
+                info.unsizedGenerics.emplace_back();
+                list(info.unsizedGenerics.back());
+            }
+            list(info.parents);
+
+            if (kind > static_cast<uint32_t>(TypeEnum::Namespace)) damaged = true;
+            if (extra != UINT32_MAX && extra >= reader.symbols.size()) damaged = true;
+            if (damaged) return nullptr;
+
+            info.extra = extra == UINT32_MAX ? InvalidSymbol : reader.symbols[extra];
+            reader.types.push_back(typeTable().intern(move(info)));
+        }
+
+        StmtPtr root = reader.node();
+        if (reader.failed || !reader.atEnd() || !root || root->getKind() != NodeType::BlockStmt) return nullptr;
+
+        return static_cast<BlockStmt*>(root);
+    }
+
+    // Cache //
+    string AstCache::pathFor(uint64_t sourceHash) const {
+        char name[24];
+        snprintf(name, sizeof(name), "%016llx.sast", static_cast<unsigned long long>(sourceHash));
+
+        return (filesystem::path(this->directory) / name).string();
+    }
+
+    BlockStmt* AstCache::load(const SourceManager& sources, FileId file, AstArena& arena) const {
+        string_view source = sources.getBuffer(file);
+        uint64_t sourceHash = hashSource(source);
+
+        string path = this->pathFor(sourceHash);
+        error_code error;
+        if (!filesystem::is_regular_file(path, error)) return nullptr;
+
+        // Mapped like a source file and decoded straight from the mapping, the tree keeps no
+        // reference to it: names are interned again and every node is copied into `arena`
+        SourceManager images;
+        FileId image;
+        try {
+            image = images.loadFile(path);
+        } catch (const exception&) {
+            return nullptr;
+        }
+
+        return readAstImage(images.getBuffer(image), sourceHash, source.size(), file, arena);
+    }
+
+    void AstCache::store(const SourceManager& sources, FileId file, const BlockStmt* block) const {
+        string_view source = sources.getBuffer(file);
+        uint64_t sourceHash = hashSource(source);
+
+        error_code error;
+        filesystem::create_directories(this->directory, error);
+        if (error) return;
+
+        string image = writeAstImage(block, sourceHash, source.size());
+
+        // Written aside and renamed, a reader never sees half an image. Compiles of the same
+        // source race on the same name, each process writes its own temporary
+        string path = this->pathFor(sourceHash);
+        string temporary = path + "." + to_string(processId()) + ".tmp";
+        {
+            ofstream output(temporary, ios::binary | ios::trunc);
+            if (!output.is_open()) return;
+
+            output.write(image.data(), static_cast<streamsize>(image.size()));
+            if (!output) {
+                output.close();
+                filesystem::remove(temporary, error);
+                return;
+            }
+        }
+
+        filesystem::rename(temporary, path, error);
+    }
+
+}
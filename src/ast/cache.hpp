@@ -0,0 +1,67 @@
+/***
+ * @file cache.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "types.hpp"
+#include "nodes.hpp"
+#include "source.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // 64-bit FNV-1a, stable across runs and platforms
+    uint64_t hashSource(string_view source);
+
+    // AST image: binary copy of a parsed tree, before Sema touches it. It holds no pointers,
+    // FileIds nor interned ids, every section sits at an 8-byte aligned offset and is read
+    // straight from the buffer:
+    //
+    //   Header
+    //   symbolStarts u32[symbols + 1], symbolBytes u8[]   Names, interned again on load
+    //   typeWords u32[]                                    Per type: kind, extra, isPointer and the
+    //                                                      count-prefixed generics, unsizedGenerics
+    //                                                      and parents, after the types they refer to
+    //   nodes u8[]                                         Pre-order stream, see cache.cpp
+    //
+    // Symbols and types inside the stream are indices into the local tables
+    constexpr uint32_t AstImageMagic = 0x54534153; // "SAST"
+    constexpr uint32_t AstImageVersion = 2;
+
+    string writeAstImage(const BlockStmt* block, uint64_t sourceHash, uint64_t sourceSize);
+
+    // Null on a foreign, stale or damaged image: sections must fill the image exactly and the
+    // payload must match the hash in the header before anything is decoded. Nodes are allocated in `arena` with positions in `file`
+    BlockStmt* readAstImage(string_view image, uint64_t sourceHash, uint64_t sourceSize, FileId file, AstArena& arena);
+
+    // Directory of AST images named after the hash of the source they were parsed from
+    class AstCache {
+    private:
+        string directory;
+
+        string pathFor(uint64_t sourceHash) const;
+
+    public:
+        explicit AstCache(string directory) : directory(move(directory)) {}
+
+        // Null on a miss, nodes are allocated in `arena`
+        BlockStmt* load(const SourceManager& sources, FileId file, AstArena& arena) const;
+
+        // Best effort, a failed write only means the next run parses again
+        void store(const SourceManager& sources, FileId file, const BlockStmt* block) const;
+    };
+
+}
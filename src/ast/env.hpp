@@ -8,7 +8,10 @@
 // Includes //
 //////////////
 
-#include "pack.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
@@ -18,130 +21,155 @@ using namespace std;
 
 namespace Solar {
 
-    struct AstEnv {
-        Type returnType;
-        bool autoRetType;
+    enum class BindingKind : uint8_t {
+        Variable,
+        Parameter,
+        Function,
+        UserType,
+    };
+
+    struct Binding {
+        Symbol name;
+        BindingKind kind;
+        TypeId type;
+        uint32_t shadowed; // Previous binding of the same name, restored when this one goes out of scope
+    };
+
+    struct Scope {
+        uint32_t firstBinding;
+        uint32_t function; // Innermost enclosing function scope, itself when isFunc
         bool isFunc;
-        unordered_map<string, Type> userTypes;
-        unordered_map<string, Type> variables;
-        unordered_map<string, Type> arguments;
-        unordered_map<string, Type> functions;
-        AstEnv* parent;
+        bool autoRetType = true;
+        TypeId returnType = PrimaryTypeId(TypeEnum::Unknow);
+    };
 
-        AstEnv(AstEnv* parent = nullptr, bool isFunc = true) : autoRetType(true), isFunc(isFunc), parent(parent) {}
+    // Scoped symbol table: every binding lives in one flat vector, scopes only mark where
+    // they start, and a name resolves in O(1) through its innermost binding.
+    // Values ( variables, parameters, functions ) and user types are separate namespaces.
+    class AstEnv {
+    private:
+        static constexpr uint32_t NoBinding = UINT32_MAX;
 
-        bool hasVariable(const string& varName) {
-            if (this->variables.find(varName) != this->variables.end()) {
-                return true;
-            }
-            if (this->parent != nullptr) { 
-                return this->parent->hasVariable(varName);
-            }
-            return false;
+        vector<Binding> bindings;
+        vector<Scope> scopes;
+        unordered_map<Symbol, uint32_t> values;
+        unordered_map<Symbol, uint32_t> userTypes;
+
+        // Global bindings in [hiddenBegin, hiddenEnd) resolve as undeclared, see limitGlobals
+        uint32_t hiddenBegin = NoBinding;
+        uint32_t hiddenEnd = NoBinding;
+
+        unordered_map<Symbol, uint32_t>& namespaceOf(BindingKind kind) {
+            return kind == BindingKind::UserType ? this->userTypes : this->values;
         }
 
-        bool hasParameter(const string& paramName) {
-            if (this->arguments.find(paramName) != this->arguments.end()) {
-                return true;
-            }
-            if (this->parent != nullptr) {
-                return this->parent->hasParameter(paramName);
+        void bind(Symbol name, BindingKind kind, TypeId type) {
+            auto& innermost = this->namespaceOf(kind);
+            uint32_t index = static_cast<uint32_t>(this->bindings.size());
+            auto [it, inserted] = innermost.try_emplace(name, index);
+
+            // Redeclared in the same scope, replace in place
+            if (!inserted && it->second >= this->scopes.back().firstBinding) {
+                Binding& binding = this->bindings[it->second];
+                binding.kind = kind;
+                binding.type = type;
+                return;
             }
-            return false;
+
+            this->bindings.push_back(Binding {name, kind, type, inserted ? NoBinding : it->second});
+            it->second = index;
         }
 
-        bool hasFunction(const string& funcName) {
-            if (this->functions.find(funcName) != this->functions.end()) {
-                return true;
-            }
-            if (this->parent != nullptr) {
-                return this->parent->hasFunction(funcName);
-            }
-            return false;
+        const Binding* find(const unordered_map<Symbol, uint32_t>& innermost, Symbol name) const {
+            auto it = innermost.find(name);
+            if (it == innermost.end() || (it->second >= this->hiddenBegin && it->second < this->hiddenEnd)) return nullptr;
+
+            return &this->bindings[it->second];
         }
 
-        bool hasUserType(const string& typeName) {
-            if (this->userTypes.find(typeName) != this->userTypes.end()) {
-                return true;
-            }
-            if (this->parent != nullptr) {
-                return this->parent->hasUserType(typeName);
+    public:
+        // Starts with the global scope, which accepts `return` like a function body
+        AstEnv() {
+            this->pushScope(true);
+        }
+
+        void pushScope(bool isFunc) {
+            uint32_t index = static_cast<uint32_t>(this->scopes.size());
+            Scope scope {static_cast<uint32_t>(this->bindings.size()), isFunc || this->scopes.empty() ? index : this->scopes.back().function, isFunc};
+            this->scopes.push_back(scope);
+        }
+
+        void popScope() {
+            uint32_t first = this->scopes.back().firstBinding;
+
+            while (this->bindings.size() > first) {
+                const Binding& binding = this->bindings.back();
+                auto& innermost = this->namespaceOf(binding.kind);
+
+                if (binding.shadowed == NoBinding) {
+                    innermost.erase(binding.name);
+                } else {
+                    innermost[binding.name] = binding.shadowed;
+                }
+
+                this->bindings.pop_back();
             }
-            return false;
+
+            this->scopes.pop_back();
         }
 
-        bool hasValue(const string& valueName) {
-            return this->hasVariable(valueName) || this->hasParameter(valueName) || this->hasFunction(valueName);
+        // Number of bindings made so far, a mark for limitGlobals
+        uint32_t mark() const {
+            return static_cast<uint32_t>(this->bindings.size());
         }
 
-        void addVariable(const string& varName, const Type& varType) {
-            this->variables[varName] = varType;
+        // Hides the global bindings made after `mark` until clearLimit, so a body checked once
+        // every global is declared still only sees the ones declared before it.
+        // Call it with only the global scope pushed
+        void limitGlobals(uint32_t mark) {
+            this->hiddenBegin = mark;
+            this->hiddenEnd = static_cast<uint32_t>(this->bindings.size());
         }
 
-        void addParameter(const string& paramName, const Type& paramType) {
-            this->arguments[paramName] = paramType;
+        void clearLimit() {
+            this->hiddenBegin = NoBinding;
+            this->hiddenEnd = NoBinding;
         }
 
-        void addUserType(const string& typeName, const Type& type) {
-            this->userTypes[typeName] = type;
+        // Innermost function scope, holds the expected return type
+        Scope& function() {
+            return this->scopes[this->scopes.back().function];
         }
 
-        void addFunction(const string& funcName, const Type& retType, const vector<Type>& argTypes) {
-            this->functions[funcName] = Type(TypeEnum::Function, false, "", {retType}, {argTypes});
+        void addVariable(Symbol varName, TypeId varType) {
+            this->bind(varName, BindingKind::Variable, varType);
         }
 
-        Type getVariableType(const string& varName) {
-            if (this->variables.find(varName) != this->variables.end()) {
-                return this->variables[varName];
-            }
-            if (this->parent != nullptr) {
-                return this->parent->getVariableType(varName);
-            }
-            return Type();
+        void addParameter(Symbol paramName, TypeId paramType) {
+            this->bind(paramName, BindingKind::Parameter, paramType);
         }
 
-        Type getParameterType(const string& paramName) {
-            if (this->arguments.find(paramName) != this->arguments.end()) {
-                return this->arguments[paramName];
-            }
-            if (this->parent != nullptr) {
-                return this->parent->getParameterType(paramName);
-            }
-            return Type();
+        void addFunction(Symbol funcName, TypeId retType, const vector<TypeId>& argTypes) {
+            this->bind(funcName, BindingKind::Function, typeTable().function(retType, argTypes));
         }
 
-        Type getUserType(const string& typeName) {
-            if (this->userTypes.find(typeName) != this->userTypes.end()) {
-                return this->userTypes[typeName];
-            }
-            if (this->parent != nullptr) {
-                return this->parent->getUserType(typeName);
-            }
-            return Type();
+        void addUserType(Symbol typeName, TypeId type) {
+            this->bind(typeName, BindingKind::UserType, type);
         }
 
-        Type getFuncType(const string& funcName) {
-            if (this->functions.find(funcName) != this->functions.end()) {
-                return this->functions[funcName];
-            }
-            if (this->parent != nullptr) {
-                return this->parent->getFuncType(funcName);
-            }
-            return Type();
+        // Innermost variable, parameter or function named `name`, nullptr when undeclared
+        const Binding* lookup(Symbol name) const {
+            return this->find(this->values, name);
         }
 
-        Type getValueType(const string& valueName) {
-            if (this->hasVariable(valueName)) {
-                return this->getVariableType(valueName);
-            }
-            if (this->hasParameter(valueName)) {
-                return this->getParameterType(valueName);
-            }
-            if (this->hasFunction(valueName)) {
-                return this->getFuncType(valueName);
-            }
-            return Type();
+        const Binding* lookupUserType(Symbol name) const {
+            return this->find(this->userTypes, name);
+        }
+
+        bool hasVariable(Symbol varName) const {
+            const Binding* binding = this->lookup(varName);
+            return binding && binding->kind == BindingKind::Variable;
         }
     };
 
-}
\ No newline at end of file
+}
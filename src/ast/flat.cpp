@@ -0,0 +1,294 @@
+/***
+ * @file flat.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "flat.hpp"
+#include <cstring>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+    template <typename T>
+    static uint64_t toBits(T value) {
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(T));
+        return bits;
+    }
+
+    template <typename T>
+    static T fromBits(uint64_t bits) {
+        T value;
+        memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    float FlatAst::getFloat(NodeId node) const {
+        return fromBits<float>(this->payloads[node]);
+    }
+
+    double FlatAst::getDouble(NodeId node) const {
+        return fromBits<double>(this->payloads[node]);
+    }
+
+    // Building //
+
+    // Children of `node` in the order they are flattened
+    static size_t childTotal(const Stmt* node) {
+        switch (node->getKind()) {
+            case NodeType::BlockStmt: return static_cast<const BlockStmt*>(node)->body.size();
+            case NodeType::FuncStmt: return static_cast<const FuncStmt*>(node)->body.size();
+            case NodeType::ReturnStmt: return 1;
+            case NodeType::VarDecStmt: return static_cast<const VarDecStmt*>(node)->value ? 1 : 0;
+            case NodeType::CallExpr: return 1 + static_cast<const CallExpr*>(node)->args.size();
+            case NodeType::UnaryExpr: return 1;
+            case NodeType::AssignmentExpr: return 1;
+            case NodeType::BinaryExpr:
+            case NodeType::LogicalExpr:
+            case NodeType::ComparasonExpr: return 2;
+            default: return 0;
+        }
+    }
+
+    static const Stmt* childAt(const Stmt* node, size_t index) {
+        switch (node->getKind()) {
+            case NodeType::BlockStmt: return static_cast<const BlockStmt*>(node)->body[index];
+            case NodeType::FuncStmt: return static_cast<const FuncStmt*>(node)->body[index];
+            case NodeType::ReturnStmt: return static_cast<const ReturnStmt*>(node)->ret;
+            case NodeType::VarDecStmt: return static_cast<const VarDecStmt*>(node)->value;
+            case NodeType::CallExpr: {
+                auto call = static_cast<const CallExpr*>(node);
+                return index == 0 ? call->left : call->args[index - 1];
+            }
+            case NodeType::UnaryExpr: return static_cast<const UnaryExpr*>(node)->value;
+            case NodeType::AssignmentExpr: return static_cast<const AssignmentExpr*>(node)->value;
+            case NodeType::BinaryExpr: {
+                auto binary = static_cast<const BinaryExpr*>(node);
+                return index == 0 ? binary->left : binary->right;
+            }
+            case NodeType::LogicalExpr: {
+                auto logical = static_cast<const LogicalExpr*>(node);
+                return index == 0 ? logical->left : logical->right;
+            }
+            case NodeType::ComparasonExpr: {
+                auto compare = static_cast<const ComparasonExpr*>(node);
+                return index == 0 ? compare->left : compare->right;
+            }
+            default: return nullptr;
+        }
+    }
+
+    // Post-order walk with an explicit stack, deep expressions can't overflow the native one.
+    // A node's children range is reserved when it is entered and each child writes its id
+    // into its slot once it is emitted, so nothing is buffered per node
+    NodeId FlatAst::add(const Stmt* root) {
+        struct Frame {
+            const Stmt* node;
+            uint32_t firstChild;
+            uint32_t childCount;
+            uint32_t nextChild;
+            uint32_t firstParam;
+            uint32_t slot; // Index in children the id goes to, UINT32_MAX for the root
+        };
+
+        vector<Frame> stack;
+        stack.reserve(64);
+        NodeId id = InvalidNode;
+
+        auto enter = [&](const Stmt* node, uint32_t slot) {
+            auto firstChild = static_cast<uint32_t>(this->children.size());
+            auto childCount = static_cast<uint32_t>(childTotal(node));
+            auto firstParam = static_cast<uint32_t>(this->params.size());
+            this->children.resize(this->children.size() + childCount, InvalidNode);
+
+            // Parameters are laid out in pre-order, enclosing functions first
+            if (node->getKind() == NodeType::FuncStmt) {
+                for (const auto& [argName, argType] : static_cast<const FuncStmt*>(node)->args) {
+                    this->params.push_back({argName, argType});
+                }
+            }
+
+            stack.push_back({node, firstChild, childCount, 0, firstParam, slot});
+        };
+
+        enter(root, UINT32_MAX);
+
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+
+            if (frame.nextChild < frame.childCount) {
+                uint32_t slot = frame.firstChild + frame.nextChild;
+                const Stmt* child = childAt(frame.node, frame.nextChild++);
+                enter(child, slot); // Invalidates `frame`
+                continue;
+            }
+
+            const Stmt* node = frame.node;
+            TypeId type = PrimaryTypeId(TypeEnum::Unknow);
+            Symbol name = InvalidSymbol;
+            uint64_t payload = 0;
+
+            // Statements come first in NodeType
+            if (node->getKind() >= NodeType::NullExpr) {
+                type = static_cast<const Expr*>(node)->type_;
+            }
+
+            switch (node->getKind()) {
+                case NodeType::BlockStmt: break;
+                case NodeType::FuncStmt: {
+                    auto func = static_cast<const FuncStmt*>(node);
+                    name = func->identifier;
+                    type = func->returnType;
+
+                    payload = frame.firstParam | (static_cast<uint64_t>(func->args.size()) << 32);
+                    break;
+                }
+                case NodeType::ReturnStmt: break;
+                case NodeType::VarDecStmt: {
+                    auto varDec = static_cast<const VarDecStmt*>(node);
+                    name = varDec->identifier;
+                    type = varDec->type;
+                    break;
+                }
+
+                case NodeType::NullExpr: break;
+                case NodeType::BoolExpr: payload = static_cast<const BoolExpr*>(node)->value; break;
+                case NodeType::IntExpr: payload = static_cast<uint64_t>(static_cast<int64_t>(static_cast<const IntExpr*>(node)->value)); break;
+                case NodeType::CharExpr: payload = static_cast<unsigned char>(static_cast<const CharExpr*>(node)->value); break;
+                case NodeType::FloatExpr: payload = toBits(static_cast<const FloatExpr*>(node)->value); break;
+                case NodeType::DoubleExpr: payload = toBits(static_cast<const DoubleExpr*>(node)->value); break;
+                case NodeType::IdentExpr: name = static_cast<const IdentExpr*>(node)->value; break;
+
+                case NodeType::CallExpr: payload = static_cast<const CallExpr*>(node)->isExpr; break;
+                case NodeType::UnaryExpr: payload = static_cast<uint64_t>(static_cast<const UnaryExpr*>(node)->op); break;
+                case NodeType::AssignmentExpr: name = static_cast<const AssignmentExpr*>(node)->identifier; break;
+                case NodeType::BinaryExpr: payload = static_cast<uint64_t>(static_cast<const BinaryExpr*>(node)->op); break;
+                case NodeType::LogicalExpr: payload = static_cast<uint64_t>(static_cast<const LogicalExpr*>(node)->op); break;
+                case NodeType::ComparasonExpr: payload = static_cast<uint64_t>(static_cast<const ComparasonExpr*>(node)->op); break;
+            }
+
+            id = static_cast<NodeId>(this->kinds.size());
+            this->kinds.push_back(node->getKind());
+            this->positions.push_back(node->pos);
+            this->types.push_back(type);
+            this->names.push_back(name);
+            this->payloads.push_back(payload);
+            this->firstChild.push_back(frame.firstChild);
+            this->childCount.push_back(frame.childCount);
+
+            if (frame.slot != UINT32_MAX) this->children[frame.slot] = id;
+            stack.pop_back();
+        }
+
+        return id;
+    }
+
+    // Debug //
+    string FlatAst::debug(NodeId node, int indent) const {
+        const string pad(indent * 2, ' ');
+        const string inner((indent + 1) * 2, ' ');
+        string result;
+
+        auto operatorExpr = [&](const string& label) {
+            result += pad + label + ": {\n";
+            result += this->debug(this->getChild(node, 0), indent + 1);
+            result += inner + "Operator: " + OpToString(this->getOp(node)) + "\n";
+            result += this->debug(this->getChild(node, 1), indent + 1);
+            result += pad + "}\n";
+        };
+
+        switch (this->kinds[node]) {
+            case NodeType::BlockStmt: {
+                result += pad + "BlockStmt: {\n";
+                for (NodeId stmt : this->getChildren(node)) {
+                    result += this->debug(stmt, indent + 1);
+                }
+                result += pad + "}\n";
+                break;
+            }
+            case NodeType::FuncStmt: {
+                result += pad + "FuncStmt: {\n";
+                result += inner + "Identifier: " + symbolName(this->names[node]) + "\n";
+                result += inner + "Return type: " + typeTable().toString(this->types[node]) + "\n";
+
+                result += inner + "Args: {\n";
+                for (auto param = this->paramsBegin(node); param != this->paramsEnd(node); ++param) {
+                    result += string((indent + 2) * 2, ' ') + "Name: " + symbolName(param->name) + "\n";
+                    result += string((indent + 2) * 2, ' ') + "Type: " + typeTable().toString(param->type) + "\n";
+                }
+                result += inner + "}\n";
+
+                result += inner + "Body: {\n";
+                for (NodeId stmt : this->getChildren(node)) {
+                    result += this->debug(stmt, indent + 2);
+                }
+                result += inner + "}\n";
+
+                result += pad + "}\n";
+                break;
+            }
+            case NodeType::ReturnStmt: {
+                result += pad + "ReturnStmt: " + this->debug(this->getChild(node), indent);
+                break;
+            }
+            case NodeType::VarDecStmt: {
+                NodeId value = this->getChild(node);
+                result += pad + "VarDecStmt: {\n";
+                result += inner + "Identifier: " + symbolName(this->names[node]) + "\n";
+                result += inner + "Value: " + (value != InvalidNode ? this->debug(value) : "") + "\n";
+                result += pad + "}\n";
+                break;
+            }
+
+            case NodeType::NullExpr: result += pad + "NullExpr\n"; break;
+            case NodeType::BoolExpr: result += pad + "BoolExpr: " + to_string(this->payloads[node] != 0) + "\n"; break;
+            case NodeType::FloatExpr: result += pad + "FloatExpr: " + to_string(this->getFloat(node)) + "\n"; break;
+            case NodeType::DoubleExpr: result += pad + "DoubleExpr: " + to_string(this->getDouble(node)) + "\n"; break;
+            case NodeType::IntExpr: result += pad + "IntExpr: " + to_string(static_cast<int>(this->payloads[node])) + "\n"; break;
+            case NodeType::CharExpr: result += pad + "CharExpr: '" + string(1, static_cast<char>(this->payloads[node])) + "'\n"; break;
+            case NodeType::IdentExpr: result += pad + "IdentExpr: " + symbolName(this->names[node]) + "\n"; break;
+
+            case NodeType::CallExpr: {
+                auto nodeChildren = this->getChildren(node);
+                result += pad + "CallExpr: {\n";
+                result += this->debug(nodeChildren[0], indent + 1);
+                result += inner + "Args: {\n";
+                for (size_t i = 1; i < nodeChildren.size(); i++) {
+                    result += this->debug(nodeChildren[i], indent + 2);
+                }
+                result += inner + "}\n";
+                result += pad + "}\n";
+                break;
+            }
+            case NodeType::UnaryExpr: {
+                result += pad + "UnaryExpr: {\n";
+                result += inner + "Operator: " + OpToString(this->getOp(node)) + "\n";
+                result += inner + "Value: " + this->debug(this->getChild(node)) + "\n";
+                result += pad + "}\n";
+                break;
+            }
+            case NodeType::AssignmentExpr: {
+                result += pad + "AssignmentExpr: {\n";
+                result += inner + "Identifier: " + symbolName(this->names[node]) + "\n";
+                result += inner + "Value: " + this->debug(this->getChild(node)) + "\n";
+                result += pad + "}\n";
+                break;
+            }
+            case NodeType::BinaryExpr: operatorExpr("BinaryExpr"); break;
+            case NodeType::LogicalExpr: operatorExpr("LogicalExpr"); break;
+            case NodeType::ComparasonExpr: operatorExpr("ComparasonExpr"); break;
+        }
+
+        return result;
+    }
+
+}
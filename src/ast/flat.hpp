@@ -0,0 +1,101 @@
+/***
+ * @file flat.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "types.hpp"
+#include "nodes.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    using NodeId = uint32_t;
+
+    const NodeId InvalidNode = UINT32_MAX;
+
+    struct NodeRange {
+        const NodeId* first;
+        const NodeId* last;
+
+        const NodeId* begin() const { return this->first; }
+        const NodeId* end() const { return this->last; }
+        size_t size() const { return static_cast<size_t>(this->last - this->first); }
+        NodeId operator[](size_t index) const { return this->first[index]; }
+    };
+
+    struct FlatParam {
+        Symbol name;
+        TypeId type;
+    };
+
+    // Struct-of-arrays copy of a BlockStmt tree, every column is indexed by NodeId.
+    // Children are always flattened before their parent, so the root is the last node.
+    //
+    // Per kind:
+    //   BlockStmt       children = body
+    //   FuncStmt        name = identifier, type = return type, payload = params range ( first | count << 32 ), children = body
+    //   ReturnStmt      children = { value }
+    //   VarDecStmt      name = identifier, type = declared type, children = { value } or {}
+    //   Bool/Int/Char   payload = value
+    //   Float/Double    payload = IEEE bits
+    //   IdentExpr       name = identifier
+    //   CallExpr        payload = isExpr, children = { callee, args... }
+    //   UnaryExpr       payload = OpCode, children = { value }
+    //   AssignmentExpr  name = target, children = { value }
+    //   Binary/Logical/ComparasonExpr  payload = OpCode, children = { left, right }
+    class FlatAst {
+    public:
+        vector<NodeType> kinds;
+        vector<TokenPos> positions;
+        vector<TypeId> types;
+        vector<Symbol> names;
+        vector<uint64_t> payloads;
+        vector<uint32_t> firstChild;
+        vector<uint32_t> childCount;
+
+        vector<NodeId> children;
+        vector<FlatParam> params;
+        NodeId root = InvalidNode;
+
+        FlatAst() = default;
+        explicit FlatAst(const BlockStmt* block) { this->root = this->add(block); }
+
+        size_t size() const { return this->kinds.size(); }
+
+        NodeRange getChildren(NodeId node) const {
+            const NodeId* first = this->children.data() + this->firstChild[node];
+            return NodeRange {first, first + this->childCount[node]};
+        }
+
+        NodeId getChild(NodeId node, size_t index = 0) const {
+            return index < this->childCount[node] ? this->children[this->firstChild[node] + index] : InvalidNode;
+        }
+
+        const FlatParam* paramsBegin(NodeId func) const { return this->params.data() + static_cast<uint32_t>(this->payloads[func]); }
+        const FlatParam* paramsEnd(NodeId func) const { return this->paramsBegin(func) + (this->payloads[func] >> 32); }
+
+        OpCode getOp(NodeId node) const { return static_cast<OpCode>(this->payloads[node]); }
+        float getFloat(NodeId node) const;
+        double getDouble(NodeId node) const;
+
+        // Same layout as Stmt::debug
+        string debug(NodeId node, int indent = 0) const;
+
+        // Appends a tree and returns its id
+        NodeId add(const Stmt* node);
+    };
+
+}
@@ -0,0 +1,272 @@
+/***
+ * @file incremental.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "incremental.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+    static void shiftPositions(Stmt* node, int64_t delta) {
+        if (!node) return;
+
+        // Placeholders from error recovery have no position to move
+        if (node->pos.file != InvalidFile) node->pos.offset = static_cast<uint32_t>(node->pos.offset + delta);
+
+        switch (node->getKind()) {
+            case NodeType::BlockStmt: {
+                for (auto stmt : static_cast<BlockStmt*>(node)->body) shiftPositions(stmt, delta);
+                break;
+            }
+            case NodeType::FuncStmt: {
+                auto func = static_cast<FuncStmt*>(node);
+                for (auto stmt : func->body) shiftPositions(stmt, delta);
+
+                if (func->lazyBody) {
+                    func->bodyBegin = static_cast<uint32_t>(func->bodyBegin + delta);
+                    func->bodyEnd = static_cast<uint32_t>(func->bodyEnd + delta);
+                }
+                break;
+            }
+            case NodeType::ReturnStmt: shiftPositions(static_cast<ReturnStmt*>(node)->ret, delta); break;
+            case NodeType::VarDecStmt: shiftPositions(static_cast<VarDecStmt*>(node)->value, delta); break;
+
+            case NodeType::CallExpr: {
+                auto call = static_cast<CallExpr*>(node);
+                shiftPositions(call->left, delta);
+                for (auto arg : call->args) shiftPositions(arg, delta);
+                break;
+            }
+            case NodeType::UnaryExpr: shiftPositions(static_cast<UnaryExpr*>(node)->value, delta); break;
+            case NodeType::AssignmentExpr: shiftPositions(static_cast<AssignmentExpr*>(node)->value, delta); break;
+            case NodeType::BinaryExpr: {
+                auto binary = static_cast<BinaryExpr*>(node);
+                shiftPositions(binary->left, delta);
+                shiftPositions(binary->right, delta);
+                break;
+            }
+            case NodeType::LogicalExpr: {
+                auto logical = static_cast<LogicalExpr*>(node);
+                shiftPositions(logical->left, delta);
+                shiftPositions(logical->right, delta);
+                break;
+            }
+            case NodeType::ComparasonExpr: {
+                auto compare = static_cast<ComparasonExpr*>(node);
+                shiftPositions(compare->left, delta);
+                shiftPositions(compare->right, delta);
+                break;
+            }
+
+            default: break; // Literals and identifiers have no children
+        }
+    }
+
+    static void shiftPositions(vector<Error>& errors, int64_t delta) {
+        for (auto& error : errors) {
+            error.pos.offset = static_cast<uint32_t>(error.pos.offset + delta);
+        }
+    }
+
+    // The only statement of the segment, if it is a function with a written return type
+    static const FuncStmt* annotatedFunc(const vector<StmtPtr>& statements) {
+        if (statements.size() != 1 || statements[0]->getKind() != NodeType::FuncStmt) return nullptr;
+
+        auto func = static_cast<const FuncStmt*>(statements[0]);
+        return func->inferReturn ? nullptr : func;
+    }
+
+    static bool sameSignature(const FuncStmt* a, const FuncStmt* b) {
+        if (a->identifier != b->identifier || a->returnType != b->returnType || a->args.size() != b->args.size()) return false;
+
+        for (size_t i = 0; i < a->args.size(); i++) {
+            if (a->args[i] != b->args[i]) return false;
+        }
+
+        return true;
+    }
+
+    // Initializers //
+    IncrementalUnit::IncrementalUnit(SourceManager& sources, string name, string text)
+        : sources(sources), file(sources.addBuffer(move(name), move(text))), parser(sources), sema(sources) {
+        this->rebuild();
+    }
+
+    // Parsing //
+    vector<IncrementalUnit::Segment> IncrementalUnit::parseRanges(const vector<pair<uint32_t, uint32_t>>& ranges) {
+        vector<Segment> parsed;
+
+        for (const auto& [begin, end] : ranges) {
+            ErrorSesion errors(&this->sources);
+            Segment segment {begin, end, this->parser.parseItems(this->file, begin, end, *this->arena, errors), errors.getErrors(), {}};
+
+            parsed.push_back(move(segment));
+        }
+
+        return parsed;
+    }
+
+    bool IncrementalUnit::hasParseErrors() const {
+        return any_of(this->segments.begin(), this->segments.end(), [](const Segment& segment) { return !segment.parseErrors.empty(); });
+    }
+
+    void IncrementalUnit::rebuild() {
+        auto size = static_cast<uint32_t>(this->sources.getBuffer(this->file).size());
+        vector<pair<uint32_t, uint32_t>> ranges;
+
+        if (!Parser::splitTopLevel(this->sources, this->file, 0, size, ranges)) {
+            ranges.assign(1, {0, size});
+        }
+
+        this->arena = make_unique<AstArena>();
+        this->segments = this->parseRanges(ranges);
+        this->garbage = 0;
+
+        this->relink();
+        this->checkAll();
+    }
+
+    void IncrementalUnit::relink() {
+        vector<StmtPtr> body;
+        for (const auto& segment : this->segments) {
+            body.insert(body.end(), segment.statements.begin(), segment.statements.end());
+        }
+
+        this->block = this->arena->make<BlockStmt>(TokenPos {this->file, 0}, this->arena->list(body));
+    }
+
+    void IncrementalUnit::checkAll() {
+        // Sema on a broken tree only adds noise, it runs again once the parse is clean
+        this->semaStale = this->hasParseErrors();
+        if (this->semaStale) return;
+
+        auto diagnostics = this->sema.checkUnit(this->block);
+        size_t index = 0;
+
+        for (auto& segment : this->segments) {
+            segment.semaErrors.clear();
+
+            for (size_t i = 0; i < segment.statements.size(); i++) {
+                const auto& errors = diagnostics[index++].getErrors();
+                segment.semaErrors.insert(segment.semaErrors.end(), errors.begin(), errors.end());
+            }
+        }
+    }
+
+    // Editing //
+    void IncrementalUnit::edit(const TextEdit& change) {
+        string_view oldText = this->sources.getBuffer(this->file);
+        if (change.begin > change.end || change.end > oldText.size()) {
+            throw runtime_error("Edit out of range: " + to_string(change.begin) + ".." + to_string(change.end));
+        }
+
+        string text;
+        text.reserve(oldText.size() - (change.end - change.begin) + change.text.size());
+        text.append(oldText.substr(0, change.begin));
+        text.append(change.text);
+        text.append(oldText.substr(change.end));
+
+        const auto newSize = static_cast<uint32_t>(text.size());
+        const int64_t delta = static_cast<int64_t>(change.text.size()) - (change.end - change.begin);
+        this->sources.replaceBuffer(this->file, move(text));
+
+        // Segments touching the edited bytes, [first, last)
+        auto first = static_cast<size_t>(partition_point(this->segments.begin(), this->segments.end(),
+            [&](const Segment& segment) { return segment.end < change.begin; }) - this->segments.begin());
+        size_t last = first;
+        while (last < this->segments.size() && this->segments[last].begin <= change.end) last++;
+
+        // Relex from the previous segment's end, growing the window until it splits cleanly again.
+        // The growth doubles so an open brace costs linear time, and when nothing splits
+        // up to the end of the file its tail is parsed as a whole to get the errors
+        uint32_t windowBegin = first > 0 ? this->segments[first - 1].end : 0;
+        uint32_t windowEnd;
+        vector<pair<uint32_t, uint32_t>> ranges;
+
+        for (size_t grow = 1;; grow *= 2) {
+            windowEnd = last < this->segments.size() ? static_cast<uint32_t>(this->segments[last].begin + delta) : newSize;
+            if (Parser::splitTopLevel(this->sources, this->file, windowBegin, windowEnd, ranges)) break;
+
+            if (last == this->segments.size()) {
+                ranges.assign(1, {windowBegin, newSize});
+                break;
+            }
+            last = min(last + grow, this->segments.size());
+        }
+
+        vector<Segment> parsed = this->parseRanges(ranges);
+        this->garbage += windowEnd - windowBegin;
+
+        for (size_t i = last; i < this->segments.size(); i++) {
+            auto& segment = this->segments[i];
+            segment.begin = static_cast<uint32_t>(segment.begin + delta);
+            segment.end = static_cast<uint32_t>(segment.end + delta);
+
+            for (auto stmt : segment.statements) shiftPositions(stmt, delta);
+            shiftPositions(segment.parseErrors, delta);
+            shiftPositions(segment.semaErrors, delta);
+        }
+
+        // Bodies can be checked on their own while every signature stays the same
+        bool onlyBodies = !this->semaStale && parsed.size() == last - first;
+        for (size_t i = 0; onlyBodies && i < parsed.size(); i++) {
+            auto before = annotatedFunc(this->segments[first + i].statements);
+            auto after = annotatedFunc(parsed[i].statements);
+
+            onlyBodies = before && after && parsed[i].parseErrors.empty() && sameSignature(before, after);
+        }
+
+        this->segments.erase(this->segments.begin() + first, this->segments.begin() + last);
+        this->segments.insert(this->segments.begin() + first, make_move_iterator(parsed.begin()), make_move_iterator(parsed.end()));
+
+        // Replaced nodes are only freed with the arena, start over once they outweigh the file a few times
+        if (this->garbage > 4 * size_t(newSize)) {
+            this->rebuild();
+            return;
+        }
+
+        this->relink();
+
+        if (!onlyBodies) {
+            this->checkAll();
+            return;
+        }
+
+        for (size_t i = first; i < first + parsed.size(); i++) {
+            auto& segment = this->segments[i];
+            ErrorSesion errors(&this->sources);
+
+            this->sema.recheckFunc(static_cast<FuncStmt*>(segment.statements[0]), errors);
+            segment.semaErrors = errors.getErrors();
+        }
+    }
+
+    vector<Error> IncrementalUnit::diagnostics() const {
+        vector<Error> result;
+
+        for (const auto& segment : this->segments) {
+            result.insert(result.end(), segment.parseErrors.begin(), segment.parseErrors.end());
+        }
+
+        if (!result.empty()) return result;
+
+        for (const auto& segment : this->segments) {
+            result.insert(result.end(), segment.semaErrors.begin(), segment.semaErrors.end());
+        }
+
+        return result;
+    }
+
+}
@@ -0,0 +1,79 @@
+/***
+ * @file incremental.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "sema.hpp"
+#include "parser.hpp"
+#include "error.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Replaces bytes [begin, end) of the source with `text`
+    struct TextEdit {
+        uint32_t begin;
+        uint32_t end;
+        string text;
+    };
+
+    // A file kept parsed and checked across edits, for editors and watch mode.
+    // The tree is cut in top-level segments, each function on its own and the statements
+    // between functions together. An edit relexes and reparses only the segments it touches,
+    // moves the positions of the ones after it, and when no signature changed only checks the
+    // edited bodies again; any other change gets a full Sema pass. Parse errors stay inside their
+    // segment, where a whole-file parse could let the recovery run on into the next function
+    class IncrementalUnit {
+    private:
+        struct Segment {
+            uint32_t begin;
+            uint32_t end;
+            vector<StmtPtr> statements;
+            vector<Error> parseErrors;
+            vector<Error> semaErrors;
+        };
+
+        SourceManager& sources;
+        FileId file;
+        Parser parser;
+        Sema sema;
+        unique_ptr<AstArena> arena;
+        vector<Segment> segments;
+        BlockStmt* block = nullptr;
+        bool semaStale = true; // Sema errors are out of date, a full pass is due
+        size_t garbage = 0; // Bytes reparsed since the arena was rebuilt, old nodes stay in it
+
+        vector<Segment> parseRanges(const vector<pair<uint32_t, uint32_t>>& ranges);
+        bool hasParseErrors() const;
+        void rebuild();
+        void relink();
+        void checkAll();
+
+    public:
+        IncrementalUnit(SourceManager& sources, string name, string text);
+
+        // Throws if the edit falls outside the source
+        void edit(const TextEdit& change);
+
+        BlockStmt* tree() const { return this->block; }
+        FileId getFile() const { return this->file; }
+
+        // Parse errors if there are any, Sema errors otherwise, in source order
+        vector<Error> diagnostics() const;
+    };
+
+}
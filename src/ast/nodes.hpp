@@ -9,8 +9,9 @@
 //////////////
 
 #include "lexer/pack.hpp"
+#include "arena.hpp"
+#include <cstdint>
 #include <string>
-#include <memory>
 #include <vector>
 
 using namespace std;
@@ -44,26 +45,81 @@ namespace Solar {
         ComparasonExpr,
     };
 
+    // Operator of Unary/Binary/Logical/ComparasonExpr, also indexes the codegen tables
+    enum class OpCode : uint8_t {
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Mod,
+        Pow,
+
+        And,
+        Or,
+
+        Eq,
+        Ne,
+        Lt,
+        Le,
+        Gt,
+        Ge,
+
+        Neg,
+        Not,
+    };
+
+    constexpr size_t OpCodeCount = static_cast<size_t>(OpCode::Not) + 1;
+
+    inline string OpToString(OpCode op) {
+        switch (op) {
+            case OpCode::Add: return "+";
+            case OpCode::Sub: return "-";
+            case OpCode::Mul: return "*";
+            case OpCode::Div: return "/";
+            case OpCode::Mod: return "%";
+            case OpCode::Pow: return "^";
+
+            case OpCode::And: return "&&";
+            case OpCode::Or: return "||";
+
+            case OpCode::Eq: return "==";
+            case OpCode::Ne: return "!=";
+            case OpCode::Lt: return "<";
+            case OpCode::Le: return "<=";
+            case OpCode::Gt: return ">";
+            case OpCode::Ge: return ">=";
+
+            case OpCode::Neg: return "-";
+            case OpCode::Not: return "!";
+        }
+
+        return "Unknown";
+    }
+
+    // Nodes are owned by an AstArena and never deleted through a base pointer
     class Stmt {
     public:
-        virtual ~Stmt() = default;
         virtual string debug(int indent = 0) const = 0;
         virtual NodeType getKind() const = 0;
 
         TokenPos pos;
+
+    protected:
+        ~Stmt() = default;
     };
 
     class Expr : public Stmt {
     public:
-        virtual ~Expr() = default;
+        TypeId type_;
 
-        Type type_;
+        explicit Expr(TypeId type = PrimaryTypeId(TypeEnum::Unknow)) : type_(type) {}
 
-        explicit Expr(Type type = Type()) : type_(type) {}
+    protected:
+        ~Expr() = default;
     };
 
-    using StmtPtr = shared_ptr<Stmt>;
-    using ExprPtr = shared_ptr<Expr>;
+    using StmtPtr = Stmt*;
+    using ExprPtr = Expr*;
 
     // ----------|
     // Statments |
@@ -71,9 +127,9 @@ namespace Solar {
 
     class BlockStmt : public Stmt {
     public:
-        vector<StmtPtr> body;
+        ArenaList<StmtPtr> body;
 
-        BlockStmt(TokenPos pos, vector<StmtPtr> body) : body(body) {
+        BlockStmt(TokenPos pos, ArenaList<StmtPtr> body) : body(body) {
             this->pos = pos;
         }
 
@@ -92,12 +148,19 @@ namespace Solar {
 
     class FuncStmt : public Stmt {
     public:
-        string identifier;
-        vector<StmtPtr> body;
-        unordered_map<string, Type> args;
-        Type returnType;
-
-        FuncStmt(TokenPos pos, string identifier, vector<StmtPtr> body, unordered_map<string, Type> args, Type returnType) : identifier(identifier), body(body), args(args), returnType(returnType) {
+        Symbol identifier;
+        ArenaList<StmtPtr> body;
+        ArenaList<pair<Symbol, TypeId>> args; // In declaration order
+        TypeId returnType; // Auto until Sema infers it
+        bool inferReturn; // Written without a return type, so Sema can check it again
+        bool exported = false; // `export func`, a codegen root like main
+
+        // Lazy bodies: `body` stays empty and only its source span is kept until Parser::parseBody
+        bool lazyBody = false;
+        uint32_t bodyBegin = 0;
+        uint32_t bodyEnd = 0;
+
+        FuncStmt(TokenPos pos, Symbol identifier, ArenaList<StmtPtr> body, ArenaList<pair<Symbol, TypeId>> args, TypeId returnType) : identifier(identifier), body(body), args(args), returnType(returnType), inferReturn(returnType == PrimaryTypeId(TypeEnum::Auto)) {
             this->pos = pos;
         }
 
@@ -105,13 +168,13 @@ namespace Solar {
             string result;
             result += string(indent * 2, ' ') + "FuncStmt: {\n";
 
-            result += string((indent + 1) * 2, ' ') + "Identifier: " + this->identifier + "\n";
-            result += string((indent + 1) * 2, ' ') + "Return type: " + this->returnType.toString() + "\n";
+            result += string((indent + 1) * 2, ' ') + "Identifier: " + symbolName(this->identifier) + "\n";
+            result += string((indent + 1) * 2, ' ') + "Return type: " + typeTable().toString(this->returnType) + "\n";
 
             result += string((indent + 1) * 2, ' ') + "Args: {\n";
             for (const auto& arg : this->args) {
-                result += string((indent + 2) * 2, ' ') + "Name: " + arg.first + "\n";
-                result += string((indent + 2) * 2, ' ') + "Type: " + arg.second.toString() + "\n";
+                result += string((indent + 2) * 2, ' ') + "Name: " + symbolName(arg.first) + "\n";
+                result += string((indent + 2) * 2, ' ') + "Type: " + typeTable().toString(arg.second) + "\n";
             }
             result += string((indent + 1) * 2, ' ') + "}\n";
 
@@ -145,17 +208,19 @@ namespace Solar {
 
     class VarDecStmt : public Stmt {
     public:
-        string identifier;
+        Symbol identifier;
+        TypeId type; // Declared type, Auto until Sema infers it
+        bool inferType; // Written without a type, so Sema can check it again
         ExprPtr value;
 
-        VarDecStmt(TokenPos pos, string identifier, ExprPtr value) : identifier(identifier), value(value) {
+        VarDecStmt(TokenPos pos, Symbol identifier, TypeId type, ExprPtr value) : identifier(identifier), type(type), inferType(type == PrimaryTypeId(TypeEnum::Auto)), value(value) {
             this->pos = pos;
         }
 
         string debug(int indent = 0) const override {
             string result;
             result += string(indent * 2, ' ') + "VarDecStmt: {\n";
-            result += string((indent + 1) * 2, ' ') + "Identifier: " + this->identifier + "\n";
+            result += string((indent + 1) * 2, ' ') + "Identifier: " + symbolName(this->identifier) + "\n";
             result += string((indent + 1) * 2, ' ') + "Value: " + this->value->debug() + "\n";
             result += string(indent * 2, ' ') + "}\n";
             return result;
@@ -171,7 +236,7 @@ namespace Solar {
     // Literal Expresisons //
     class NullExpr : public Expr {
     public:
-        NullExpr(TokenPos pos) : Expr(Type(TypeEnum::Null)) {
+        NullExpr(TokenPos pos) : Expr(PrimaryTypeId(TypeEnum::Null)) {
             this->pos = pos;
         }
 
@@ -187,7 +252,7 @@ namespace Solar {
         bool value;
 
         BoolExpr(TokenPos pos, bool value) 
-            : Expr(Type(TypeEnum::Bool)), value(value) {
+            : Expr(PrimaryTypeId(TypeEnum::Bool)), value(value) {
             this->pos = pos;
         }
 
@@ -203,7 +268,7 @@ namespace Solar {
         float value;
 
         FloatExpr(TokenPos pos, float value) 
-            : Expr(Type(TypeEnum::Float)), value(value) {
+            : Expr(PrimaryTypeId(TypeEnum::Float)), value(value) {
             this->pos = pos;
         }
 
@@ -219,7 +284,7 @@ namespace Solar {
         double value;
 
         DoubleExpr(TokenPos pos, double value) 
-            : Expr(Type(TypeEnum::Double)), value(value) {
+            : Expr(PrimaryTypeId(TypeEnum::Double)), value(value) {
             this->pos = pos;
         }
 
@@ -235,7 +300,7 @@ namespace Solar {
         int value;
 
         IntExpr(TokenPos pos, int value) 
-            : Expr(Type(TypeEnum::Int)), value(value) {
+            : Expr(PrimaryTypeId(TypeEnum::Int)), value(value) {
             this->pos = pos;
         }
 
@@ -251,7 +316,7 @@ namespace Solar {
         char value;
 
         CharExpr(TokenPos pos, char value) 
-            : Expr(Type(TypeEnum::Char)), value(value) {
+            : Expr(PrimaryTypeId(TypeEnum::Char)), value(value) {
             this->pos = pos;
         }
 
@@ -264,15 +329,15 @@ namespace Solar {
 
     class IdentExpr : public Expr {
     public:
-        string value;
+        Symbol value;
 
-        IdentExpr(TokenPos pos, Type type, string value)
+        IdentExpr(TokenPos pos, TypeId type, Symbol value)
             : Expr(type), value(value) {
             this->pos = pos;
         }
 
         string debug(int indent = 0) const override {
-            return string(indent * 2, ' ') + "IdentExpr: " + this->value + "\n";
+            return string(indent * 2, ' ') + "IdentExpr: " + symbolName(this->value) + "\n";
         }
 
         NodeType getKind() const override { return NodeType::IdentExpr; }
@@ -281,10 +346,10 @@ namespace Solar {
     // Complex expresisons //
     class UnaryExpr : public Expr {
     public:
-        string op;
+        OpCode op;
         ExprPtr value;
 
-        UnaryExpr(TokenPos pos, string op, ExprPtr value)
+        UnaryExpr(TokenPos pos, OpCode op, ExprPtr value)
         : Expr(value->type_), op(op), value(value) {
             this->pos = pos;
         }
@@ -292,7 +357,7 @@ namespace Solar {
         string debug(int indent = 0) const override {
             string result;
             result += string(indent * 2, ' ') + "UnaryExpr: {\n";
-            result += string((indent + 1) * 2, ' ') + "Operator: " + this->op + "\n";
+            result += string((indent + 1) * 2, ' ') + "Operator: " + OpToString(this->op) + "\n";
             result += string((indent + 1) * 2, ' ') + "Value: " + this->value->debug() + "\n";
             result += string(indent * 2, ' ') + "}\n";
             return result;
@@ -303,18 +368,18 @@ namespace Solar {
 
     class AssignmentExpr : public Expr {
     public:
-        string identifier;
+        Symbol identifier;
         ExprPtr value;
 
-        AssignmentExpr(TokenPos pos, string identifier, ExprPtr value)
-        : Expr(Type(TypeEnum::Null)), identifier(identifier), value(value) {
+        AssignmentExpr(TokenPos pos, Symbol identifier, ExprPtr value)
+        : Expr(PrimaryTypeId(TypeEnum::Null)), identifier(identifier), value(value) {
             this->pos = pos;
         }
 
         string debug(int indent = 0) const override {
             string result;
             result += string(indent * 2, ' ') + "AssignmentExpr: {\n";
-            result += string((indent + 1) * 2, ' ') + "Identifier: " + this->identifier + "\n";
+            result += string((indent + 1) * 2, ' ') + "Identifier: " + symbolName(this->identifier) + "\n";
             result += string((indent + 1) * 2, ' ') + "Value: " + this->value->debug() + "\n";
             result += string(indent * 2, ' ') + "}\n";
             return result;
@@ -326,10 +391,10 @@ namespace Solar {
     class BinaryExpr : public Expr {
     public:
         ExprPtr left;
-        string op;
+        OpCode op;
         ExprPtr right;
 
-        BinaryExpr(TokenPos pos, ExprPtr left, string op, ExprPtr right)
+        BinaryExpr(TokenPos pos, ExprPtr left, OpCode op, ExprPtr right)
             : left(left), op(op), right(right) {
                 this->pos = pos;
             }
@@ -338,7 +403,7 @@ namespace Solar {
             string result;
             result += string(indent * 2, ' ') + "BinaryExpr: {\n";
             result += this->left->debug(indent + 1);
-            result += string((indent + 1) * 2, ' ') + "Operator: " + this->op + "\n";
+            result += string((indent + 1) * 2, ' ') + "Operator: " + OpToString(this->op) + "\n";
             result += this->right->debug(indent + 1);
             result += string(indent * 2, ' ') + "}\n";
             return result;
@@ -350,11 +415,11 @@ namespace Solar {
     class LogicalExpr : public Expr {
     public:
         ExprPtr left;
-        string op;
+        OpCode op;
         ExprPtr right;
 
-        LogicalExpr(TokenPos pos, ExprPtr left, string op, ExprPtr right)
-            : Expr(Type(TypeEnum::Bool)), left(left), op(op), right(right) {
+        LogicalExpr(TokenPos pos, ExprPtr left, OpCode op, ExprPtr right)
+            : Expr(PrimaryTypeId(TypeEnum::Bool)), left(left), op(op), right(right) {
                 this->pos = pos;
             }
 
@@ -362,7 +427,7 @@ namespace Solar {
             string result;
             result += string(indent * 2, ' ') + "LogicalExpr: {\n";
             result += this->left->debug(indent + 1);
-            result += string((indent + 1) * 2, ' ') + "Operator: " + this->op + "\n";
+            result += string((indent + 1) * 2, ' ') + "Operator: " + OpToString(this->op) + "\n";
             result += this->right->debug(indent + 1);
             result += string(indent * 2, ' ') + "}\n";
             return result;
@@ -374,11 +439,11 @@ namespace Solar {
     class ComparasonExpr : public Expr {
     public:
         ExprPtr left;
-        string op;
+        OpCode op;
         ExprPtr right;
 
-        ComparasonExpr(TokenPos pos, ExprPtr left, string op, ExprPtr right)
-            : Expr(Type(TypeEnum::Bool)), left(left), op(op), right(right) {
+        ComparasonExpr(TokenPos pos, ExprPtr left, OpCode op, ExprPtr right)
+            : Expr(PrimaryTypeId(TypeEnum::Bool)), left(left), op(op), right(right) {
                 this->pos = pos;
             }
 
@@ -386,7 +451,7 @@ namespace Solar {
             string result;
             result += string(indent * 2, ' ') + "ComparasonExpr: {\n";
             result += this->left->debug(indent + 1);
-            result += string((indent + 1) * 2, ' ') + "Operator: " + this->op + "\n";
+            result += string((indent + 1) * 2, ' ') + "Operator: " + OpToString(this->op) + "\n";
             result += this->right->debug(indent + 1);
             result += string(indent * 2, ' ') + "}\n";
             return result;
@@ -398,10 +463,10 @@ namespace Solar {
     class CallExpr : public Expr {
     public:
         ExprPtr left;
-        vector<ExprPtr> args;
+        ArenaList<ExprPtr> args;
         bool isExpr;
 
-        CallExpr(TokenPos pos, Type type, ExprPtr left, vector<ExprPtr> args, bool isExpr = false)
+        CallExpr(TokenPos pos, TypeId type, ExprPtr left, ArenaList<ExprPtr> args, bool isExpr = false)
             : Expr(type), left(left), args(args), isExpr(isExpr) {
                 this->pos = pos;
             }
@@ -3,4 +3,9 @@
 #include "types.hpp"
 #include "env.hpp"
 #include "nodes.hpp"
-#include "parser.hpp"
\ No newline at end of file
+#include "flat.hpp"
+#include "cache.hpp"
+#include "sema.hpp"
+#include "parser.hpp"
+#include "incremental.hpp"
+#include "bench.hpp"
\ No newline at end of file
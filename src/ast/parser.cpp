@@ -7,6 +7,9 @@
 //////////////
 
 #include "parser.hpp"
+#include "parallel.hpp"
+#include <atomic>
+#include <stdexcept>
 
 using namespace std;
 
@@ -17,14 +20,15 @@ using namespace std;
 namespace Solar {
     // Helpers //
     Token Parser::next() {
-        auto tk = this->actual();
-        this->tokens.erase(this->tokens.begin());
+        return this->stream->next();
+    }
 
-        return tk;
+    const Token& Parser::actual() {
+        return this->stream->peek();
     }
 
-    Token Parser::actual() {
-        return this->tokens[0];
+    const Token& Parser::peek(size_t ahead) {
+        return this->stream->peek(ahead);
     }
 
     Token Parser::opcional(TokenType expected) {
@@ -44,109 +48,309 @@ namespace Solar {
                 TToString(expected) +
                 ", but founded: " +
                 TToString(tk.type),
-                tk.pos.file,
-                tk.pos.line,
-                tk.pos.collum
+                tk.pos
             );
         }
 
         return tk;
     }
 
-    Type Parser::parseType(AstEnv& env) {
+    TypeId Parser::parseType() {
         auto tk = this->next();
 
         if (tk.type != TokenType::Identfier && tk.type != TokenType::Null) {
             this->errSession.addError(
                 "Expected type, but founded: " +
                 TToString(tk.type),
-                tk.pos.file,
-                tk.pos.line,
-                tk.pos.collum
+                tk.pos
             );
 
-            return Type();
+            return PrimaryTypeId(TypeEnum::Unknow);
         }
 
-        auto itPrimary = primaryTypes.find(tk.content);
-        if (itPrimary != primaryTypes.end()) {
-            return Type(itPrimary->second);
-        }
-
-        if (env.hasUserType(tk.content)) {
-            return env.getUserType(tk.content);
+        auto primary = PrimaryType(tk.content);
+        if (primary != TypeEnum::Unknow) {
+            return PrimaryTypeId(primary);
         }
 
         this->errSession.addError(
             "Expecting type name, but founded: " +
-            tk.content,
-            tk.pos.file,
-            tk.pos.line,
-            tk.pos.collum
+            string(tk.content),
+            tk.pos
         );
-        return Type();
+        return PrimaryTypeId(TypeEnum::Unknow);
     }
 
     bool Parser::notEOF() {
-        return this->tokens[0].type != TokenType::EOF_;
+        return this->actual().type != TokenType::EOF_;
     }
 
     // Initializers //
-    shared_ptr<BlockStmt> Parser::parseCode(string source, string file) {
-        this->tokens = tokenize(source, file);
-        vector<shared_ptr<Stmt>> body;
-        AstEnv env;
+    BlockStmt* Parser::parseCode(FileId file, AstArena& arena, bool parallel) {
+        this->arena = &arena;
+
+        if (parallel) {
+            if (auto block = this->parseParallel(file)) return block;
+        }
+
+        vector<StmtPtr> body = this->parseRange(file, 0, UINT32_MAX);
+
+        // Sema reports "No errors found." once the whole unit is checked
+        if (this->errSession.hasErrors()) this->errSession.debug();
+        return this->arena->make<BlockStmt>(TokenPos {file, 0}, this->arena->list(body));
+    }
+
+    void Parser::parseBody(FuncStmt* func, AstArena& arena) {
+        if (!func->lazyBody) return;
+
+        this->arena = &arena;
+        this->funcDepth++;
+        vector<StmtPtr> body = this->parseRange(func->pos.file, func->bodyBegin, func->bodyEnd);
+        this->funcDepth--;
+
+        if (this->errSession.hasErrors()) this->errSession.debug();
+
+        func->body = this->arena->list(body);
+        func->lazyBody = false;
+    }
+
+    // Parallel mode //
+    vector<StmtPtr> Parser::parseStatements() {
+        vector<StmtPtr> body;
 
         while (this->notEOF()) {
-            body.push_back(this->parseStmt(env));
+            body.push_back(this->parseStmt());
+        }
+
+        return body;
+    }
+
+    vector<StmtPtr> Parser::parseRange(FileId file, uint32_t begin, uint32_t end) {
+        this->stream = make_unique<TokenStream>(this->sources, file, this->errSession, begin, end, &this->symbolCache);
+        return this->parseStatements();
+    }
+
+    vector<StmtPtr> Parser::parseTokens(const Token* first, const Token* last, const Token& eof) {
+        this->stream = make_unique<TokenStream>(first, last, eof);
+        return this->parseStatements();
+    }
+
+    vector<StmtPtr> Parser::parseItems(FileId file, uint32_t begin, uint32_t end, AstArena& arena, ErrorSesion& errors) {
+        this->arena = &arena;
+        vector<StmtPtr> body;
+
+        try {
+            body = this->parseRange(file, begin, end);
+        } catch (const exception& error) {
+            this->errSession.addError(error.what(), TokenPos {file, begin});
         }
 
-        this->errSession.debug();
-        return make_shared<BlockStmt>(body[0]->pos, body);
+        errors.merge(this->errSession);
+        return body;
+    }
+
+    bool Parser::splitTokens(const vector<Token>& tokens, vector<TopLevelRange>& ranges) {
+        const uint32_t NoToken = UINT32_MAX;
+        ranges.clear();
+
+        uint32_t gapFirst = 0;
+        bool gapHasTokens = false;
+        uint32_t funcFirst = 0;
+        bool inFunc = false;
+        uint32_t exportIndex = NoToken; // `export` waiting for its `func`
+        size_t depth = 0;
+        uint32_t index = 0;
+
+        for (; tokens[index].type != TokenType::EOF_; index++) {
+            TokenType type = tokens[index].type;
+
+            if (depth == 0 && !inFunc) {
+                if (type == TokenType::Export) {
+                    if (exportIndex != NoToken) gapHasTokens = true;
+
+                    exportIndex = index;
+                    continue;
+                }
+
+                if (type == TokenType::Func) {
+                    funcFirst = exportIndex != NoToken ? exportIndex : index;
+                    if (gapHasTokens) ranges.push_back({gapFirst, funcFirst, false});
+
+                    exportIndex = NoToken;
+                    inFunc = true;
+                    continue;
+                }
+
+                exportIndex = NoToken;
+                gapHasTokens = true;
+            }
+
+            if (type == TokenType::OpenCurly) {
+                depth++;
+            } else if (type == TokenType::CloseCurly) {
+                if (depth == 0) return false; // Left for the sequential parser to report
+
+                if (--depth == 0 && inFunc) {
+                    ranges.push_back({funcFirst, index + 1, true});
+
+                    gapFirst = index + 1;
+                    gapHasTokens = false;
+                    inFunc = false;
+                }
+            }
+        }
+
+        if (exportIndex != NoToken) gapHasTokens = true;
+        if (depth != 0 || inFunc) return false;
+        if (gapHasTokens) ranges.push_back({gapFirst, index, false});
+
+        return true;
+    }
+
+    bool Parser::splitTopLevel(const SourceManager& sources, FileId file, uint32_t begin, uint32_t end, vector<pair<uint32_t, uint32_t>>& ranges) {
+        ErrorSesion scanErrors(&sources);
+        SymbolCache symbolCache;
+        Lexer lexer(sources, file, scanErrors, begin, end, &symbolCache);
+        ranges.clear();
+
+        vector<Token> tokens;
+        do {
+            tokens.push_back(lexer.next());
+        } while (tokens.back().type != TokenType::EOF_);
+
+        vector<TopLevelRange> pieces;
+        if (scanErrors.hasErrors() || !splitTokens(tokens, pieces)) return false;
+
+        // Functions span their own tokens, the statements between them every byte up to the next function
+        for (size_t i = 0; i < pieces.size(); i++) {
+            const auto& piece = pieces[i];
+
+            if (piece.isFunc) {
+                ranges.emplace_back(tokens[piece.first].pos.offset, tokens[piece.last - 1].pos.offset + 1);
+            } else {
+                uint32_t gapBegin = ranges.empty() ? begin : ranges.back().second;
+                ranges.emplace_back(gapBegin, i + 1 < pieces.size() ? tokens[pieces[i + 1].first].pos.offset : end);
+            }
+        }
+
+        return true;
+    }
+
+    BlockStmt* Parser::parseParallel(FileId file) {
+        // Lexed once, through this parser's symbol cache. Workers parse slices of the tokens, so
+        // nothing is lexed twice and no worker touches the interner; the parser itself only
+        // makes primary TypeIds, which need no type table
+        ErrorSesion lexErrors(&this->sources);
+        Lexer lexer(this->sources, file, lexErrors, 0, UINT32_MAX, &this->symbolCache);
+
+        vector<Token> tokens;
+        tokens.reserve(this->sources.getBuffer(file).size() / 4);
+        do {
+            tokens.push_back(lexer.next());
+        } while (tokens.back().type != TokenType::EOF_);
+
+        vector<TopLevelRange> ranges;
+        if (lexErrors.hasErrors() || !splitTokens(tokens, ranges) || ranges.size() < 2) return nullptr;
+
+        // One parser and arena per worker, their arenas are adopted by ours once every range parsed
+        size_t workers = parallelWorkers(ranges.size());
+        vector<unique_ptr<Parser>> parsers(workers);
+        vector<unique_ptr<AstArena>> arenas(workers);
+        vector<vector<StmtPtr>> results(ranges.size());
+        atomic<bool> failed {false};
+
+        try {
+            parallelFor(ranges.size(), [&](size_t index, size_t worker) {
+                if (!parsers[worker]) {
+                    parsers[worker] = make_unique<Parser>(this->sources, this->lazyBodies);
+                    arenas[worker] = make_unique<AstArena>();
+                    parsers[worker]->arena = arenas[worker].get();
+                }
+
+                // A range ends where the next token starts, like the Lexer's EOF at the end of its bytes
+                const auto& range = ranges[index];
+                Token eof {tokens[range.last].pos, TokenType::EOF_, InvalidSymbol, string_view()};
+
+                auto& parser = *parsers[worker];
+                results[index] = parser.parseTokens(tokens.data() + range.first, tokens.data() + range.last, eof);
+
+                if (parser.errSession.hasErrors()) failed = true;
+            });
+        } catch (...) {
+            return nullptr;
+        }
+
+        if (failed) return nullptr;
+
+        vector<StmtPtr> body;
+        for (auto& statements : results) {
+            body.insert(body.end(), statements.begin(), statements.end());
+        }
+
+        for (auto& workerArena : arenas) {
+            if (workerArena) this->arena->adopt(move(*workerArena));
+        }
+
+        return this->arena->make<BlockStmt>(TokenPos {file, 0}, this->arena->list(body));
     }
 
     // Statments //
-    StmtPtr Parser::parseStmt(AstEnv& env) {
+    StmtPtr Parser::parseStmt() {
         switch (this->actual().type) {
             case TokenType::Func: {
-                return this->parseFuncStmt("", env);
+                return this->parseFuncStmt(InvalidSymbol);
+                break;
+            }
+            case TokenType::Export: {
+                auto tk = this->next();
+
+                if (this->actual().type != TokenType::Func) {
+                    this->errSession.addError(
+                        "Only functions can be exported, but founded: " +
+                        TToString(this->actual().type),
+                        tk.pos
+                    );
+
+                    return this->parseStmt();
+                }
+
+                auto func = static_cast<FuncStmt*>(this->parseFuncStmt(InvalidSymbol));
+                func->exported = true;
+
+                return func;
                 break;
             }
             case TokenType::Return: {
-                return this->parseReturnStmt(env);
+                return this->parseReturnStmt();
                 break;
             }
             case TokenType::Var: {
-                return this->parseVarDecStmt(env);
+                return this->parseVarDecStmt();
                 break;
             }
 
-            default: return this->parseExpr(env); break;
+            default: return this->parseExpr(); break;
         }
     }
 
-    StmtPtr Parser::parseFuncStmt(string name, AstEnv& env) {
-        this->next();
+    StmtPtr Parser::parseFuncStmt(Symbol name) {
+        auto tk = this->next();
         vector<StmtPtr> body;
-        unordered_map<string, Type> args;
-        vector<Type> argsType;
+        vector<pair<Symbol, TypeId>> args;
+        TypeId returnType = PrimaryTypeId(TypeEnum::Auto); // Inferred by Sema
 
-        AstEnv newEnv(env);
-
-        if (name.empty()) {
-            name = this->expect(TokenType::Identfier).content;
+        if (name == InvalidSymbol) {
+            name = this->expect(TokenType::Identfier).symbol;
         }
 
         this->expect(TokenType::OpenParen);
 
         while (this->notEOF() && this->actual().type != TokenType::CloseParen) {
-            auto ident = this->expect(TokenType::Identfier).content;
+            auto ident = this->expect(TokenType::Identfier).symbol;
             this->expect(TokenType::Colon);
-            auto type_ = this->parseType(newEnv);
+            auto type_ = this->parseType();
 
-            args[ident] = type_;
-            argsType.push_back(type_);
-            newEnv.addParameter(ident, type_);
+            args.emplace_back(ident, type_);
 
             if (this->actual().type == TokenType::Comma) {
                 this->next();
@@ -159,186 +363,185 @@ namespace Solar {
 
         if (this->actual().type == TokenType::Colon) {
             this->next();
-            newEnv.returnType = this->parseType(env);
-            newEnv.autoRetType = false;
+            returnType = this->parseType();
         }
 
         this->expect(TokenType::OpenCurly);
 
-        while (this->notEOF() && this->actual().type != TokenType::CloseCurly) {
-            body.push_back(this->parseStmt(newEnv));
-        }
+        // The signature is all Sema needs from other functions, skip to the matching brace
+        if (this->lazyBodies && this->funcDepth == 0 && returnType != PrimaryTypeId(TypeEnum::Auto)) {
+            uint32_t bodyBegin = this->actual().pos.offset;
+            size_t depth = 0;
 
-        this->expect(TokenType::CloseCurly);
+            while (this->notEOF() && (depth > 0 || this->actual().type != TokenType::CloseCurly)) {
+                auto type = this->next().type;
 
-        env.addFunction(name, newEnv.returnType, argsType);
-        return make_shared<FuncStmt>(body[0]->pos, name, body, args, newEnv.returnType);
-    }
+                if (type == TokenType::OpenCurly) depth++;
+                else if (type == TokenType::CloseCurly) depth--;
+            }
 
-    StmtPtr Parser::parseReturnStmt(AstEnv& env) {
-        auto tk = this->next();
-        auto expr = this->parseExpr(env);
+            uint32_t bodyEnd = this->actual().pos.offset;
+            this->expect(TokenType::CloseCurly);
+
+            auto func = this->arena->make<FuncStmt>(tk.pos, name, ArenaList<StmtPtr>(), this->arena->list(args), returnType);
+            func->lazyBody = true;
+            func->bodyBegin = bodyBegin;
+            func->bodyEnd = bodyEnd;
 
-        if (env.autoRetType) {
-            env.returnType = expr->type_;
+            return func;
         }
 
-        if (!expr->type_.compare(env.returnType)) {
-            this->errSession.addError(
-                "Expected a return value of type: " +
-                env.returnType.toString() +
-                ", but found: " +
-                expr->type_.toString(),
-                tk.pos.file,
-                tk.pos.line,
-                tk.pos.collum
-            );
+        this->funcDepth++;
+        while (this->notEOF() && this->actual().type != TokenType::CloseCurly) {
+            body.push_back(this->parseStmt());
         }
+        this->funcDepth--;
 
-        this->opcional(TokenType::Semicolon);
-        return make_shared<ReturnStmt>(tk.pos, expr);
+        this->expect(TokenType::CloseCurly);
+
+        return this->arena->make<FuncStmt>(tk.pos, name, this->arena->list(body), this->arena->list(args), returnType);
     }
 
-    StmtPtr Parser::parseVarDecStmt(AstEnv& env) {
+    StmtPtr Parser::parseReturnStmt() {
         auto tk = this->next();
-        auto ident = this->expect(TokenType::Identfier).content;
+        auto expr = this->parseExpr();
 
-        if (env.hasVariable(ident)) {
-            this->errSession.addError(
-                "Variable: " + ident + " already declared",
-                tk.pos.file, tk.pos.line, tk.pos.collum
-            );
-        }
+        this->opcional(TokenType::Semicolon);
+        return this->arena->make<ReturnStmt>(tk.pos, expr);
+    }
 
-        bool autoType = false;
-        Type type;
+    StmtPtr Parser::parseVarDecStmt() {
+        auto tk = this->next();
+        auto ident = this->expect(TokenType::Identfier).symbol;
+        TypeId type = PrimaryTypeId(TypeEnum::Auto); // Inferred by Sema
 
         if (this->actual().type == TokenType::Colon) {
             this->next();
-            type = this->parseType(env);
-        } else {
-            autoType = true;
+            type = this->parseType();
         }
 
         ExprPtr expr = nullptr;
         if (this->actual().type == TokenType::Assignment) {
             this->next();
-            expr = this->parseExpr(env);
-        }
-
-        if (autoType) {
-            if (!expr) {
-                this->errSession.addError(
-                    "Cannot infer type for variable: " + ident + " without an assignment",
-                    tk.pos.file, tk.pos.line, tk.pos.collum
-                );
-            } else {
-                type = expr->type_;
-            }
-        }
-
-        if (!autoType && expr && !expr->type_.compare(type)) {
-            this->errSession.addError(
-                "Expected a value of type: " + type.toString() + 
-                ", but found: " + expr->type_.toString(),
-                tk.pos.file, tk.pos.line, tk.pos.collum
-            );
+            expr = this->parseExpr();
         }
 
-        env.addVariable(ident, type);
         this->opcional(TokenType::Semicolon);
 
-        return make_shared<VarDecStmt>(tk.pos, ident, expr);
+        return this->arena->make<VarDecStmt>(tk.pos, ident, type, expr);
     }
 
     // Expressions order
     // Assignment Expr
-    // Call Expr
-    // Logical Expr
-    // Comparason Expr
-    // Additive Expr
-    // Multiplicative Expr
-    // Exponential Expr
+    // Infix Expr ( see InfixRules )
     // Unary Expr
+    // Call Expr
     // Primary Expr
 
-    // Expresisons //
-    template <typename expr>
-    ExprPtr Parser::parseOperatorExpr(std::function<ExprPtr()> subExpr, const vector<string>& ops, bool typeCheck, [[maybe_unused]] AstEnv& env) {
-        auto left = subExpr();
+    struct InfixRule {
+        int precedence = 0; // 0 means the token is not an infix operator
+        bool rightAssoc = false;
+        NodeType kind = NodeType::BinaryExpr;
+        OpCode op = OpCode::Add;
+    };
+
+    // Binding power of every infix operator, indexed by TokenType
+    static constexpr array<InfixRule, TokenTypeCount> InfixRules = [] {
+        array<InfixRule, TokenTypeCount> rules {};
+        auto set = [&rules](TokenType type, int precedence, NodeType kind, OpCode op) {
+            rules[static_cast<size_t>(type)] = InfixRule {precedence, false, kind, op};
+        };
 
-        auto validOp = [ops](string op) {
-            for (auto const& inOp : ops)
-                if (inOp == op) return true;
+        set(TokenType::And, 1, NodeType::LogicalExpr, OpCode::And);
+        set(TokenType::Or, 1, NodeType::LogicalExpr, OpCode::Or);
 
-            return false;
-        };
+        set(TokenType::Less, 2, NodeType::ComparasonExpr, OpCode::Lt);
+        set(TokenType::LessEquals, 2, NodeType::ComparasonExpr, OpCode::Le);
+        set(TokenType::Greater, 2, NodeType::ComparasonExpr, OpCode::Gt);
+        set(TokenType::GreaterEquals, 2, NodeType::ComparasonExpr, OpCode::Ge);
+        set(TokenType::Equals, 2, NodeType::ComparasonExpr, OpCode::Eq);
+        set(TokenType::NotEquals, 2, NodeType::ComparasonExpr, OpCode::Ne);
 
-        while (this->notEOF() && validOp(this->actual().content)) {
-            auto op = this->next();
-            auto right = subExpr();
+        set(TokenType::Plus, 3, NodeType::BinaryExpr, OpCode::Add);
+        set(TokenType::Minus, 3, NodeType::BinaryExpr, OpCode::Sub);
 
-            if (typeCheck && !right->type_.compare(left->type_)) {
-                this->errSession.addError(
-                    "Expected a value of type: " +
-                    left->type_.toString() +
-                    ", but found: " +
-                    right->type_.toString(),
-                    op.pos.file,
-                    op.pos.line,
-                    op.pos.collum
-                );
-            }
+        set(TokenType::Star, 4, NodeType::BinaryExpr, OpCode::Mul);
+        set(TokenType::Slash, 4, NodeType::BinaryExpr, OpCode::Div);
+        set(TokenType::Mod, 4, NodeType::BinaryExpr, OpCode::Mod);
+
+        set(TokenType::Pow, 5, NodeType::BinaryExpr, OpCode::Pow);
+
+        return rules;
+    }();
+
+    // Expresisons //
+    ExprPtr Parser::parseExpr() {
+        return this->parseAssignExpr();
+    }
 
-            left = make_shared<expr>(op.pos, left, op.content, right);
+    ExprPtr Parser::parseAssignExpr() {
+        auto left = this->parseInfixExpr();
 
-            if (typeCheck) left->type_ = right->type_; 
+        if (left->getKind() == NodeType::IdentExpr && this->actual().type == TokenType::Assignment) {
+            auto op = this->next();
+            auto right = this->parseInfixExpr();
+
+            left = this->arena->make<AssignmentExpr>(op.pos, static_cast<IdentExpr*>(left)->value, right);
         }
 
         return left;
     }
 
-    ExprPtr Parser::parseExpr(AstEnv& env) {
-        return this->parseAssignExpr(env);
-    }
+    // Precedence climbing, only operators binding at least as tight as `minPrecedence` are taken
+    ExprPtr Parser::parseInfixExpr(int minPrecedence) {
+        auto left = this->parseUnaryExpr();
 
-    ExprPtr Parser::parseAssignExpr(AstEnv& env) {
-        auto left = this->parseCallExpr(env);
+        while (true) {
+            const InfixRule& rule = InfixRules[static_cast<size_t>(this->actual().type)];
+            if (rule.precedence == 0 || rule.precedence < minPrecedence) break;
 
-        if (left->getKind() == NodeType::IdentExpr && this->actual().content == "=") {
             auto op = this->next();
-            auto right = this->parseCallExpr(env);
+            auto right = this->parseInfixExpr(rule.rightAssoc ? rule.precedence : rule.precedence + 1);
 
-            left = make_shared<AssignmentExpr>(op.pos, static_pointer_cast<IdentExpr>(left)->value, right);
+            switch (rule.kind) {
+                case NodeType::LogicalExpr:
+                    left = this->arena->make<LogicalExpr>(op.pos, left, rule.op, right);
+                    break;
+                case NodeType::ComparasonExpr:
+                    left = this->arena->make<ComparasonExpr>(op.pos, left, rule.op, right);
+                    break;
+
+                default:
+                    left = this->arena->make<BinaryExpr>(op.pos, left, rule.op, right);
+                    break;
+            }
         }
 
         return left;
     }
 
-    ExprPtr Parser::parseCallExpr(AstEnv& env) {
-        auto left = this->parseLogicalExpr(env);
+    ExprPtr Parser::parseUnaryExpr() {
+        auto type = this->actual().type;
 
-        while (this->actual().type == TokenType::OpenParen) {
+        if (type == TokenType::Minus || type == TokenType::Not) {
+            auto op = this->next();
+            auto right = this->parseUnaryExpr();
 
-            if (!left || left->type_.kind != TypeEnum::Function) {
-                this->errSession.addError(
-                    "Cannot call a non-function value or null expression",
-                    this->actual().pos.file,
-                    this->actual().pos.line,
-                    this->actual().pos.collum
-                );
-                this->next();
-                break;
-            }
+            return this->arena->make<UnaryExpr>(op.pos, type == TokenType::Minus ? OpCode::Neg : OpCode::Not, right);
+        }
 
+        return this->parseCallExpr();
+    }
+
+    ExprPtr Parser::parseCallExpr() {
+        auto left = this->parsePrimaryExpr();
+
+        while (this->actual().type == TokenType::OpenParen) {
             auto op = this->expect(TokenType::OpenParen);
             vector<ExprPtr> args;
-            vector<Type> argsType;
 
             while (this->notEOF() && this->actual().type != TokenType::CloseParen) {
-                auto arg = this->parseExpr(env);
-                args.push_back(arg);
-                argsType.push_back(arg->type_);
+                args.push_back(this->parseExpr());
 
                 if (this->actual().type == TokenType::Comma) {
                     this->next();
@@ -347,92 +550,29 @@ namespace Solar {
                 }
             }
 
-            for (size_t i = 0; i < argsType.size(); ++i) {
-                if (i >= left->type_.unsizedGenerics[0].size() || 
-                    !argsType[i].compare(left->type_.unsizedGenerics[0][i])) {
-                    this->errSession.addError(
-                        "Expected argument " + to_string(i + 1) + " of type: " +
-                        (i < left->type_.unsizedGenerics[0].size() ? 
-                            left->type_.unsizedGenerics[0][i].toString() : "unknown") +
-                        ", but found: " +
-                        argsType[i].toString(),
-                        op.pos.file,
-                        op.pos.line,
-                        op.pos.collum
-                    );
-                }
-            }
-
             this->expect(TokenType::CloseParen);
-            left = make_shared<CallExpr>(op.pos, left->type_.generics[0].kind, left, args);
+            left = this->arena->make<CallExpr>(op.pos, PrimaryTypeId(TypeEnum::Unknow), left, this->arena->list(args));
         }
 
         return left;
     }
 
-    ExprPtr Parser::parseLogicalExpr(AstEnv& env) {
-        return this->parseOperatorExpr<LogicalExpr>([this, &env](){ return this->parseComparasonExpr(env); }, {"&&", "||"}, false, env);
-    }
-
-    ExprPtr Parser::parseComparasonExpr(AstEnv& env) {
-        return this->parseOperatorExpr<ComparasonExpr>([this, &env](){ return this->parseAdditiveExpr(env); }, {"<=", "<", ">", ">=", "==", "!="}, false, env);
-    }
-
-    ExprPtr Parser::parseAdditiveExpr(AstEnv& env) {
-        return this->parseOperatorExpr<BinaryExpr>([this, &env](){ return this->parseMultiplicativeExpr(env); }, {"+", "-"}, true, env);
-    }
-
-    ExprPtr Parser::parseMultiplicativeExpr(AstEnv& env) {
-        return this->parseOperatorExpr<BinaryExpr>([this, &env](){ return this->parseExponentialExpr(env); }, {"*", "/", "%"}, true, env);
-    }
-
-    ExprPtr Parser::parseExponentialExpr(AstEnv& env) {
-        return this->parseOperatorExpr<BinaryExpr>([this, &env](){ return this->parseUnaryExpr(env); }, {"^"}, true, env);
-    }
-
-    ExprPtr Parser::parseUnaryExpr(AstEnv& env) {
-        auto tk = this->actual();
-
-        if (tk.content == "-" || tk.content == "!") {
-            auto op = this->next();
-            auto right = this->parseUnaryExpr(env);
-
-            return make_shared<UnaryExpr>(op.pos, op.content, right);
-        }
-
-        return this->parsePrimaryExpr(env);
-    }
-
-    ExprPtr Parser::parsePrimaryExpr(AstEnv& env) {
+    ExprPtr Parser::parsePrimaryExpr() {
         auto tk = this->actual();
 
         switch (tk.type) {
-            case TokenType::Null: return make_shared<NullExpr>(tk.pos); break;
-            case TokenType::Bool: return make_shared<BoolExpr>(tk.pos, this->next().content == "true" ? true : false); break;
-            case TokenType::Int: return make_shared<IntExpr>(tk.pos, stoi(this->next().content)); break;
-            case TokenType::Double: return make_shared<DoubleExpr>(tk.pos, stold(this->next().content)); break;
-            case TokenType::Float: return make_shared<FloatExpr>(tk.pos, stod(this->next().content)); break;
-            case TokenType::Char: return make_shared<CharExpr>(tk.pos, this->next().content[0]); break;
-
-            case TokenType::Identfier: {
-                if (!env.hasValue(tk.content)) {
-                    this->errSession.addError(
-                        "Used variable: " +
-                        tk.content +
-                        " not declared",
-                        tk.pos.file,
-                        tk.pos.line,
-                        tk.pos.collum
-                    );
-                }
+            case TokenType::Null: return this->arena->make<NullExpr>(tk.pos); break;
+            case TokenType::Bool: return this->arena->make<BoolExpr>(tk.pos, this->next().content == "true" ? true : false); break;
+            case TokenType::Int: return this->arena->make<IntExpr>(tk.pos, stoi(string(this->next().content))); break;
+            case TokenType::Double: return this->arena->make<DoubleExpr>(tk.pos, stold(string(this->next().content))); break;
+            case TokenType::Float: return this->arena->make<FloatExpr>(tk.pos, stod(string(this->next().content))); break;
+            case TokenType::Char: return this->arena->make<CharExpr>(tk.pos, this->next().content[0]); break;
 
-                return make_shared<IdentExpr>(tk.pos, env.getValueType(tk.content), this->next().content); 
-                break;
-            }
+            case TokenType::Identfier: return this->arena->make<IdentExpr>(tk.pos, PrimaryTypeId(TypeEnum::Unknow), this->next().symbol); break;
 
             case TokenType::OpenParen: {
                 this->next();
-                auto tkn = this->parseExpr(env);
+                auto tkn = this->parseExpr();
                 this->expect(TokenType::CloseParen);
 
                 return tkn;
@@ -444,12 +584,10 @@ namespace Solar {
                 this->errSession.addError(
                     "Unexpected token: " +
                     TToString(tk.type),
-                    tok.pos.file,
-                    tok.pos.line,
-                    tok.pos.collum
+                    tok.pos
                 );
 
-                return make_shared<NullExpr>(TokenPos());
+                return this->arena->make<NullExpr>(TokenPos());
                 break;
             }
         }
@@ -9,12 +9,15 @@
 //////////////
 
 #include "lexer/pack.hpp"
-#include "pack.hpp"
+#include "types.hpp"
+#include "nodes.hpp"
 #include "error.hpp"
+#include <array>
+#include <cstdint>
 #include <vector>
-#include <functional>
 #include <unordered_map>
 #include <memory>
+#include <utility>
 
 using namespace std;
 
@@ -26,40 +29,79 @@ namespace Solar {
 
     class Parser {
     private:
+        const SourceManager& sources;
         ErrorSesion errSession;
-        vector<Token> tokens;
+        AstArena* arena = nullptr;
+        bool lazyBodies;
+        size_t funcDepth = 0; // Function bodies being parsed, only top-level ones are deferred
+        unique_ptr<TokenStream> stream; // Pulled on demand, no full token vector
+        SymbolCache symbolCache; // Kept across ranges and reparses
 
         // Helpers //
         Token next();
-        Token actual();
+        const Token& actual();
+        const Token& peek(size_t ahead = 1);
         Token opcional(TokenType expected);
         Token expect(TokenType expeted);
-        Type parseType(AstEnv& env);
+        TypeId parseType();
         bool notEOF();
 
         // Statments //
-        StmtPtr parseStmt(AstEnv& env);
-        StmtPtr parseFuncStmt(string name, AstEnv& env);
-        StmtPtr parseReturnStmt(AstEnv& env);
-        StmtPtr parseVarDecStmt(AstEnv& env);
+        StmtPtr parseStmt();
+        StmtPtr parseFuncStmt(Symbol name);
+        StmtPtr parseReturnStmt();
+        StmtPtr parseVarDecStmt();
 
         // Expressions //
-        template <typename Expr>
-        ExprPtr parseOperatorExpr(std::function<ExprPtr()> subExpr, const vector<string>& ops, bool typeCheck, AstEnv& env);
-        ExprPtr parseExpr(AstEnv& env);
-        ExprPtr parseAssignExpr(AstEnv& env);
-        ExprPtr parseLogicalExpr(AstEnv& env);
-        ExprPtr parseComparasonExpr(AstEnv& env);
-        ExprPtr parseAdditiveExpr(AstEnv& env);
-        ExprPtr parseMultiplicativeExpr(AstEnv& env);
-        ExprPtr parseExponentialExpr(AstEnv& env);
-        ExprPtr parseUnaryExpr(AstEnv& env);
-        ExprPtr parseCallExpr(AstEnv& env);
-
-        ExprPtr parsePrimaryExpr(AstEnv& env);
+        ExprPtr parseExpr();
+        ExprPtr parseAssignExpr();
+        ExprPtr parseInfixExpr(int minPrecedence = 1);
+        ExprPtr parseUnaryExpr();
+        ExprPtr parseCallExpr();
+
+        ExprPtr parsePrimaryExpr();
+
+        // Parallel mode //
+        // Top-level function, or run of other statements between two of them, as token indices [first, last)
+        struct TopLevelRange {
+            uint32_t first;
+            uint32_t last;
+            bool isFunc;
+        };
+
+        // Every statement left in the stream
+        vector<StmtPtr> parseStatements();
+        // Top-level statements found in bytes [begin, end) of the file
+        vector<StmtPtr> parseRange(FileId file, uint32_t begin, uint32_t end);
+        // Top-level statements in tokens [first, last), read without lexing again
+        vector<StmtPtr> parseTokens(const Token* first, const Token* last, const Token& eof);
+        // Null when some range fails, so the sequential parse can report it in source order
+        BlockStmt* parseParallel(FileId file);
+
+        // Token form of splitTopLevel, `tokens` ends with EOF_
+        static bool splitTokens(const vector<Token>& tokens, vector<TopLevelRange>& ranges);
     public:
+        // With `lazyBodies`, top-level functions with a declared return type keep only their
+        // signature and body span, parseBody fills them in when codegen first reaches them
+        Parser(const SourceManager& sources, bool lazyBodies = false) : sources(sources), errSession(&sources), lazyBodies(lazyBodies) {}
+
         // Intializers //
-        shared_ptr<BlockStmt> parseCode(string source, string file = "Unknow");
+        // Every node is allocated in `arena`, which must outlive the returned tree.
+        // Only syntax is checked, names and types are resolved later by Sema.
+        // With `parallel`, top-level functions are parsed on worker threads, the tree is the same either way
+        BlockStmt* parseCode(FileId file, AstArena& arena, bool parallel = false);
+        // Parses a deferred body into `arena`, does nothing if it was parsed already
+        void parseBody(FuncStmt* func, AstArena& arena);
+
+        // Incremental mode //
+        // Top-level statements in bytes [begin, end) of the file, which must start and end
+        // between two of them. Diagnostics are moved to `errors`, nothing is printed nor thrown
+        vector<StmtPtr> parseItems(FileId file, uint32_t begin, uint32_t end, AstArena& arena, ErrorSesion& errors);
+
+        // Splits bytes [begin, end) into ranges covering every top-level token, each top-level
+        // function in a range of its own. False when the bytes do not split cleanly on their own
+        // (lexer errors, unbalanced braces); `begin` must sit between two top-level statements
+        static bool splitTopLevel(const SourceManager& sources, FileId file, uint32_t begin, uint32_t end, vector<pair<uint32_t, uint32_t>>& ranges);
     };
 
 }
@@ -0,0 +1,333 @@
+/***
+ * @file sema.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "sema.hpp"
+#include "parallel.hpp"
+#include <memory>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+    vector<TypeId> Sema::paramTypes(const FuncStmt* node) {
+        vector<TypeId> params;
+        params.reserve(node->args.size());
+
+        for (const auto& arg : node->args) {
+            params.push_back(arg.second);
+        }
+
+        return params;
+    }
+
+    // Initializers //
+    void Sema::check(BlockStmt* root) {
+        for (auto& errors : this->checkUnit(root)) {
+            this->errSession.merge(errors);
+        }
+
+        this->errSession.debug();
+    }
+
+    vector<ErrorSesion> Sema::checkUnit(BlockStmt* root) {
+        const auto& body = root->body;
+        AstEnv& global = this->global;
+        global = AstEnv();
+        this->globalMarks.clear();
+
+        for (StmtPtr stmt : body) {
+            if (stmt->getKind() != NodeType::FuncStmt) continue;
+
+            auto func = static_cast<FuncStmt*>(stmt);
+            if (!func->inferReturn) {
+                global.addFunction(func->identifier, func->returnType, paramTypes(func));
+            }
+        }
+
+        // One session per top-level statement, merged back in order
+        vector<ErrorSesion> diagnostics(body.size(), ErrorSesion(&this->sources));
+        vector<size_t> deferred;
+
+        for (size_t i = 0; i < body.size(); i++) {
+            StmtPtr stmt = body[i];
+
+            if (stmt->getKind() == NodeType::FuncStmt && !static_cast<FuncStmt*>(stmt)->inferReturn) {
+                auto func = static_cast<FuncStmt*>(stmt);
+                this->globalMarks[func->identifier] = global.mark();
+
+                if (!func->lazyBody) deferred.push_back(i);
+                continue;
+            }
+
+            this->checkStmt(stmt, global, diagnostics[i]);
+        }
+
+        // Bodies only read the global scope, each worker gets its own copy to push scopes on
+        vector<unique_ptr<AstEnv>> envs(parallelWorkers(deferred.size()));
+        parallelFor(deferred.size(), [&](size_t index, size_t worker) {
+            if (!envs[worker]) envs[worker] = make_unique<AstEnv>(global);
+
+            size_t i = deferred[index];
+            auto func = static_cast<FuncStmt*>(body[i]);
+
+            envs[worker]->limitGlobals(this->globalMarks.at(func->identifier));
+            this->checkFunc(func, *envs[worker], diagnostics[i]);
+        });
+
+        return diagnostics;
+    }
+
+    void Sema::checkBody(FuncStmt* func) {
+        ErrorSesion errors(&this->sources);
+        this->recheckFunc(func, errors);
+
+        if (errors.hasErrors()) errors.debug();
+    }
+
+    void Sema::recheckFunc(FuncStmt* func, ErrorSesion& errors) {
+        // Scopes pushed for the body are popped again, the global scope is left as it was
+        auto mark = this->globalMarks.find(func->identifier);
+        if (mark != this->globalMarks.end()) this->global.limitGlobals(mark->second);
+
+        this->checkFunc(func, this->global, errors);
+        this->global.clearLimit();
+    }
+
+    // Statments //
+    void Sema::checkStmt(StmtPtr node, AstEnv& env, ErrorSesion& errors) const {
+        switch (node->getKind()) {
+            case NodeType::BlockStmt: {
+                for (StmtPtr stmt : static_cast<BlockStmt*>(node)->body) {
+                    this->checkStmt(stmt, env, errors);
+                }
+                break;
+            }
+            case NodeType::FuncStmt: {
+                auto func = static_cast<FuncStmt*>(node);
+                this->checkFunc(func, env, errors);
+
+                // Declared after its body, like any other binding
+                env.addFunction(func->identifier, func->returnType, paramTypes(func));
+                break;
+            }
+            case NodeType::ReturnStmt: {
+                this->checkReturn(static_cast<ReturnStmt*>(node), env, errors);
+                break;
+            }
+            case NodeType::VarDecStmt: {
+                this->checkVarDec(static_cast<VarDecStmt*>(node), env, errors);
+                break;
+            }
+
+            default: {
+                this->checkExpr(static_cast<Expr*>(node), env, errors);
+                break;
+            }
+        }
+    }
+
+    void Sema::checkFunc(FuncStmt* node, AstEnv& env, ErrorSesion& errors) const {
+        env.pushScope(true);
+
+        Scope& function = env.function();
+        function.autoRetType = node->inferReturn;
+        function.returnType = function.autoRetType ? PrimaryTypeId(TypeEnum::Unknow) : node->returnType;
+
+        for (const auto& [name, type] : node->args) {
+            env.addParameter(name, type);
+        }
+
+        for (StmtPtr stmt : node->body) {
+            this->checkStmt(stmt, env, errors);
+        }
+
+        // Without a return statement there is nothing to infer from
+        if (env.function().autoRetType && env.function().returnType == PrimaryTypeId(TypeEnum::Unknow)) {
+            env.function().returnType = PrimaryTypeId(TypeEnum::Null);
+        }
+
+        node->returnType = env.function().returnType;
+        env.popScope();
+    }
+
+    void Sema::checkReturn(ReturnStmt* node, AstEnv& env, ErrorSesion& errors) const {
+        this->checkExpr(node->ret, env, errors);
+        TypeId type = node->ret->type_;
+
+        Scope& function = env.function();
+        if (function.autoRetType) {
+            function.returnType = type;
+        }
+
+        if (type != function.returnType) {
+            errors.addError(
+                "Expected a return value of type: " +
+                typeTable().toString(function.returnType) +
+                ", but found: " +
+                typeTable().toString(type),
+                node->pos
+            );
+        }
+    }
+
+    void Sema::checkVarDec(VarDecStmt* node, AstEnv& env, ErrorSesion& errors) const {
+        if (env.hasVariable(node->identifier)) {
+            errors.addError(
+                "Variable: " + symbolName(node->identifier) + " already declared",
+                node->pos
+            );
+        }
+
+        if (node->value) {
+            this->checkExpr(node->value, env, errors);
+        }
+
+        if (node->inferType) {
+            if (!node->value) {
+                errors.addError(
+                    "Cannot infer type for variable: " + symbolName(node->identifier) + " without an assignment",
+                    node->pos
+                );
+                node->type = PrimaryTypeId(TypeEnum::Unknow);
+            } else {
+                node->type = node->value->type_;
+            }
+        } else if (node->value && node->value->type_ != node->type) {
+            errors.addError(
+                "Expected a value of type: " + typeTable().toString(node->type) +
+                ", but found: " + typeTable().toString(node->value->type_),
+                node->pos
+            );
+        }
+
+        env.addVariable(node->identifier, node->type);
+    }
+
+    // Expressions //
+    void Sema::checkExpr(ExprPtr node, AstEnv& env, ErrorSesion& errors) const {
+        switch (node->getKind()) {
+            case NodeType::IdentExpr: {
+                auto ident = static_cast<IdentExpr*>(node);
+                const Binding* binding = env.lookup(ident->value);
+
+                if (!binding) {
+                    errors.addError(
+                        "Used variable: " +
+                        symbolName(ident->value) +
+                        " not declared",
+                        ident->pos
+                    );
+                }
+
+                ident->type_ = binding ? binding->type : PrimaryTypeId(TypeEnum::Unknow);
+                break;
+            }
+            case NodeType::AssignmentExpr: {
+                auto assign = static_cast<AssignmentExpr*>(node);
+
+                if (!env.lookup(assign->identifier)) {
+                    errors.addError(
+                        "Used variable: " +
+                        symbolName(assign->identifier) +
+                        " not declared",
+                        assign->pos
+                    );
+                }
+
+                this->checkExpr(assign->value, env, errors);
+                break;
+            }
+            case NodeType::UnaryExpr: {
+                auto unary = static_cast<UnaryExpr*>(node);
+                this->checkExpr(unary->value, env, errors);
+                unary->type_ = unary->value->type_;
+                break;
+            }
+            case NodeType::BinaryExpr: {
+                auto binary = static_cast<BinaryExpr*>(node);
+                this->checkExpr(binary->left, env, errors);
+                this->checkExpr(binary->right, env, errors);
+
+                if (binary->right->type_ != binary->left->type_) {
+                    errors.addError(
+                        "Expected a value of type: " +
+                        typeTable().toString(binary->left->type_) +
+                        ", but found: " +
+                        typeTable().toString(binary->right->type_),
+                        binary->pos
+                    );
+                }
+
+                binary->type_ = binary->right->type_;
+                break;
+            }
+            case NodeType::LogicalExpr: {
+                auto logical = static_cast<LogicalExpr*>(node);
+                this->checkExpr(logical->left, env, errors);
+                this->checkExpr(logical->right, env, errors);
+                break;
+            }
+            case NodeType::ComparasonExpr: {
+                auto compare = static_cast<ComparasonExpr*>(node);
+                this->checkExpr(compare->left, env, errors);
+                this->checkExpr(compare->right, env, errors);
+                break;
+            }
+            case NodeType::CallExpr: {
+                this->checkCall(static_cast<CallExpr*>(node), env, errors);
+                break;
+            }
+
+            default: break; // Literals are typed by the parser
+        }
+    }
+
+    void Sema::checkCall(CallExpr* node, AstEnv& env, ErrorSesion& errors) const {
+        this->checkExpr(node->left, env, errors);
+
+        for (ExprPtr arg : node->args) {
+            this->checkExpr(arg, env, errors);
+        }
+
+        if (typeTable().kind(node->left->type_) != TypeEnum::Function) {
+            errors.addError(
+                "Cannot call a non-function value or null expression",
+                node->pos
+            );
+            node->type_ = PrimaryTypeId(TypeEnum::Unknow);
+            return;
+        }
+
+        // A bare `func` type has no signature, nothing to check against
+        const TypeInfo& signature = typeTable().get(node->left->type_);
+        static const vector<TypeId> noParams;
+        const vector<TypeId>& params = signature.unsizedGenerics.empty() ? noParams : signature.unsizedGenerics[0];
+
+        for (size_t i = 0; i < node->args.size(); ++i) {
+            TypeId argType = node->args[i]->type_;
+
+            if (i >= params.size() || argType != params[i]) {
+                errors.addError(
+                    "Expected argument " + to_string(i + 1) + " of type: " +
+                    (i < params.size() ? typeTable().toString(params[i]) : "unknown") +
+                    ", but found: " +
+                    typeTable().toString(argType),
+                    node->pos
+                );
+            }
+        }
+
+        node->type_ = signature.generics.empty() ? PrimaryTypeId(TypeEnum::Unknow) : signature.generics[0];
+    }
+
+}
@@ -0,0 +1,67 @@
+/***
+ * @file sema.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "types.hpp"
+#include "env.hpp"
+#include "nodes.hpp"
+#include "error.hpp"
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Resolves names and types on a parsed tree, filling Expr::type_ and the inferred
+    // return/variable types. Runs in three steps:
+    //   1. Signatures of every top-level function with a declared return type,
+    //      so any function can call another wherever it is declared
+    //   2. Top-level statements and functions with an inferred return type, in order
+    //   3. Remaining function bodies, in parallel, each with its own error session;
+    //      sessions are merged in source order so diagnostics do not depend on scheduling.
+    //      A body sees every signature from step 1 but only the globals declared before it.
+    // Lazy bodies are skipped and go through checkBody once the parser fills them.
+    class Sema {
+    private:
+        const SourceManager& sources;
+        ErrorSesion errSession;
+        AstEnv global; // Kept after check() for bodies parsed later
+        unordered_map<Symbol, uint32_t> globalMarks; // Global bindings visible to each deferred body, by function name
+
+        // Every check reports into `errors` and resolves through `env`, both owned by the caller
+        void checkStmt(StmtPtr node, AstEnv& env, ErrorSesion& errors) const;
+        void checkFunc(FuncStmt* node, AstEnv& env, ErrorSesion& errors) const;
+        void checkReturn(ReturnStmt* node, AstEnv& env, ErrorSesion& errors) const;
+        void checkVarDec(VarDecStmt* node, AstEnv& env, ErrorSesion& errors) const;
+
+        void checkExpr(ExprPtr node, AstEnv& env, ErrorSesion& errors) const;
+        void checkCall(CallExpr* node, AstEnv& env, ErrorSesion& errors) const;
+
+        static vector<TypeId> paramTypes(const FuncStmt* node);
+    public:
+        Sema(const SourceManager& sources) : sources(sources), errSession(&sources) {}
+
+        // Prints "No errors found." or every diagnostic, throwing in the latter case
+        void check(BlockStmt* root);
+        // Same checks, printing nothing: one session per top-level statement, in order
+        vector<ErrorSesion> checkUnit(BlockStmt* root);
+
+        // Checks a lazy body parsed after check(), throwing on errors like check()
+        void checkBody(FuncStmt* func);
+        // Checks a body again against the global scope of the last check, which its
+        // signature must still match. Errors go to `errors`
+        void recheckFunc(FuncStmt* func, ErrorSesion& errors);
+    };
+
+}
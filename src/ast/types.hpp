@@ -9,7 +9,15 @@
 //////////////
 
 #include "lexer/pack.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 using namespace std;
 
@@ -37,56 +45,263 @@ namespace Solar {
         Namespace,
     };
 
-    const unordered_map<string, TypeEnum> primaryTypes = {
-        {"null", TypeEnum::Null},
-        {"bool", TypeEnum::Bool},
-        {"int", TypeEnum::Int},
-        {"float", TypeEnum::Float},
-        {"double", TypeEnum::Double},
-        {"char", TypeEnum::Char},
-        {"func", TypeEnum::Function},
+    // Built-in type names, Unknow when `name` is not one
+    constexpr TypeEnum PrimaryType(string_view name) {
+        switch (name.size()) {
+            case 3:
+                if (name == "int") return TypeEnum::Int;
+                break;
+            case 4:
+                switch (name[0]) {
+                    case 'n': if (name == "null") return TypeEnum::Null; break;
+                    case 'b': if (name == "bool") return TypeEnum::Bool; break;
+                    case 'c': if (name == "char") return TypeEnum::Char; break;
+                    case 'f': if (name == "func") return TypeEnum::Function; break;
+                }
+                break;
+            case 5:
+                if (name == "float") return TypeEnum::Float;
+                break;
+            case 6:
+                if (name == "double") return TypeEnum::Double;
+                break;
+        }
+
+        return TypeEnum::Unknow;
+    }
+
+    // Handle to a type interned in the TypeTable, equal ids mean equal types
+    using TypeId = uint32_t;
+
+    // Primary kinds are interned first and in TypeEnum order, so their id is the enum value
+    constexpr TypeId PrimaryTypeId(TypeEnum kind) {
+        return static_cast<TypeId>(kind);
+    }
+
+    // Primary types sharing a family convert freely between each other ( "Int & Float = Number" )
+    enum class TypeFamily : uint8_t {
+        None,
+        Void,
+        Bool,
+        Number,
+        Double,
+        Alfa,
+        Function,
+
+        Custom, // User types, never convert through the family
+    };
+
+    // Dense index of a user type in the inheritance hierarchy, primary and function types have none
+    constexpr uint32_t NoHierarchy = UINT32_MAX;
+
+    // Structure of an interned type, only built once per distinct type
+    struct TypeInfo {
+        TypeEnum kind = TypeEnum::Unknow;
+        Symbol extra = InvalidSymbol; // User-Type name
+        bool isPointer = false;
+        vector<TypeId> generics; // Function: { return type }
+        vector<vector<TypeId>> unsizedGenerics; // Function: { parameter types }
+        vector<TypeId> parents; // User types, must be interned before the child
+
+        // Filled by the table
+        TypeFamily family = TypeFamily::None;
+        bool primaryType = true;
+        uint32_t hierarchyIndex = NoHierarchy;
+        vector<uint64_t> ancestors; // Bitset over hierarchy indices of the type itself and every transitive parent
     };
 
-    struct Type {
-        TypeEnum kind;
-        string extra; // User-Type name
-        string family; // "Int & Float = Number" and etc
-        bool isPointer;
-        vector<string> parents;
-        bool primaryType;
-        vector<Type> generics;
-        vector<vector<Type>> unsizedGenerics;
+    class TypeTable {
+    private:
+        mutable shared_mutex mutex;
+        deque<TypeInfo> infos; // Deque keeps returned references valid while it grows
+        unordered_map<string, TypeId> ids;
+        uint32_t hierarchySize = 0; // User types interned so far, the next hierarchy index
+
+        mutable shared_mutex cacheMutex;
+        mutable unordered_map<uint64_t, bool> convertCache; // ( from << 32 | to ), types never change once interned
+
+        // Every structural field packed as raw 32-bit words
+        static string key(const TypeInfo& info) {
+            string result;
+            auto word = [&result](uint32_t value) { result.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+            word(static_cast<uint32_t>(info.kind));
+            word(info.extra);
+            word(info.isPointer);
+
+            word(static_cast<uint32_t>(info.generics.size()));
+            for (TypeId generic : info.generics) word(generic);
 
-        bool compare(Type other) const {
-            if (other.kind != this->kind) return false;
-            if (other.extra != this->extra) return false;
+            word(static_cast<uint32_t>(info.unsizedGenerics.size()));
+            for (const auto& list : info.unsizedGenerics) {
+                word(static_cast<uint32_t>(list.size()));
+                for (TypeId generic : list) word(generic);
+            }
+
+            word(static_cast<uint32_t>(info.parents.size()));
+            for (TypeId parent : info.parents) word(parent);
+
+            return result;
+        }
+
+        static void setBit(vector<uint64_t>& bits, size_t index) {
+            if (bits.size() <= index / 64) bits.resize(index / 64 + 1, 0);
+            bits[index / 64] |= uint64_t(1) << (index % 64);
+        }
+
+        static bool testBit(const vector<uint64_t>& bits, size_t index) {
+            return index / 64 < bits.size() && (bits[index / 64] >> (index % 64)) & 1;
+        }
+
+        static bool intersects(const vector<uint64_t>& a, const vector<uint64_t>& b) {
+            size_t words = min(a.size(), b.size());
+            for (size_t i = 0; i < words; i++) {
+                if (a[i] & b[i]) return true;
+            }
 
-            return true;
+            return false;
         }
 
-        bool canConvert(Type other) const {
-            if (other.kind == this->kind) return true;
-            if ((other.family == this->family) && (this->primaryType == true && other.primaryType == true)) return true;
+        // Called under the unique lock, only user types take a hierarchy index so ancestor sets
+        // grow with the number of classes and structs, not with every signature interned
+        void classify(TypeInfo& info) {
+            info.primaryType = true;
+
+            switch (info.kind) {
+                case TypeEnum::Null: info.family = TypeFamily::Void; break;
+                case TypeEnum::Bool: info.family = TypeFamily::Bool; break;
+                case TypeEnum::Int: info.family = TypeFamily::Number; break;
+                case TypeEnum::Double: info.family = TypeFamily::Double; break;
+                case TypeEnum::Float: info.family = TypeFamily::Number; break;
+                case TypeEnum::Char: info.family = TypeFamily::Alfa; break;
+                case TypeEnum::Function: info.family = TypeFamily::Function; break;
 
-            if (([this, other](){
-                for (const auto& parent : this->parents) {
-                    for (const auto& otherParent : other.parents) {
-                        if (parent == otherParent) return true;
-                    }
+                case TypeEnum::Auto: // Same unknow
+                case TypeEnum::Unknow: info.family = TypeFamily::None; break;
+
+                default: {
+                    info.family = TypeFamily::Custom;
+                    info.primaryType = false;
+                    break;
                 }
+            }
 
-                return false;
-            })()) return true;
+            info.ancestors.clear();
+            info.hierarchyIndex = NoHierarchy;
+            if (info.primaryType) return;
 
-            if ((this->extra == other.extra) && (this->primaryType == false && other.primaryType == false)) return true;
+            info.hierarchyIndex = this->hierarchySize++;
+            setBit(info.ancestors, info.hierarchyIndex);
 
-            return false;
+            for (TypeId parent : info.parents) {
+                if (parent >= this->infos.size()) continue;
+
+                const auto& inherited = this->infos[parent].ancestors;
+                if (info.ancestors.size() < inherited.size()) info.ancestors.resize(inherited.size(), 0);
+                for (size_t i = 0; i < inherited.size(); i++) info.ancestors[i] |= inherited[i];
+            }
         }
 
-        string toString() const {
+    public:
+        TypeTable() {
+            for (auto kind = TypeEnum::Auto; kind <= TypeEnum::Function; kind = static_cast<TypeEnum>(static_cast<int>(kind) + 1)) {
+                TypeInfo info;
+                info.kind = kind;
+                this->intern(info);
+            }
+        }
+
+        TypeTable(const TypeTable&) = delete;
+        TypeTable& operator=(const TypeTable&) = delete;
+
+        TypeId intern(TypeInfo info) {
+            string infoKey = key(info);
+
+            {
+                shared_lock<shared_mutex> lock(this->mutex);
+                auto it = this->ids.find(infoKey);
+                if (it != this->ids.end()) return it->second;
+            }
+
+            unique_lock<shared_mutex> lock(this->mutex);
+            auto it = this->ids.find(infoKey);
+            if (it != this->ids.end()) return it->second;
+
+            TypeId id = static_cast<TypeId>(this->infos.size());
+            this->classify(info);
+            this->infos.push_back(move(info));
+            this->ids.emplace(move(infoKey), id);
+
+            return id;
+        }
+
+        TypeId function(TypeId returnType, const vector<TypeId>& params) {
+            TypeInfo info;
+            info.kind = TypeEnum::Function;
+            info.generics = {returnType};
+            info.unsizedGenerics = {params};
+            return this->intern(move(info));
+        }
+
+        TypeId userType(TypeEnum kind, Symbol name) {
+            TypeInfo info;
+            info.kind = kind;
+            info.extra = name;
+            return this->intern(move(info));
+        }
+
+        const TypeInfo& get(TypeId id) const {
+            shared_lock<shared_mutex> lock(this->mutex);
+            return this->infos[id];
+        }
+
+        TypeEnum kind(TypeId id) const {
+            return this->get(id).kind;
+        }
+
+        size_t size() const {
+            shared_lock<shared_mutex> lock(this->mutex);
+            return this->infos.size();
+        }
+
+        // `from` is `to` or inherits from it
+        bool isSubtype(TypeId from, TypeId to) const {
+            if (from == to) return true;
+
+            uint32_t index = this->get(to).hierarchyIndex;
+            return index != NoHierarchy && testBit(this->get(from).ancestors, index);
+        }
+
+        // Same kind, same primary family, subtype or common ancestor, or same user type name.
+        // Primary types never look at the bitsets
+        bool canConvert(TypeId from, TypeId to) const {
+            if (from == to) return true;
+
+            uint64_t pair = (static_cast<uint64_t>(from) << 32) | to;
+            {
+                shared_lock<shared_mutex> lock(this->cacheMutex);
+                auto it = this->convertCache.find(pair);
+                if (it != this->convertCache.end()) return it->second;
+            }
+
+            const TypeInfo& self = this->get(from);
+            const TypeInfo& other = this->get(to);
+
+            bool result = self.kind == other.kind ||
+                (self.primaryType && other.primaryType && self.family == other.family) ||
+                (!self.primaryType && !other.primaryType && (intersects(self.ancestors, other.ancestors) || self.extra == other.extra));
+
+            unique_lock<shared_mutex> lock(this->cacheMutex);
+            this->convertCache.emplace(pair, result);
+
+            return result;
+        }
+
+        string toString(TypeId id) const {
+            const TypeInfo& info = this->get(id);
             string typeName;
 
-            switch (this->kind) {
+            switch (info.kind) {
                 case TypeEnum::Auto: typeName = "Auto"; break;
                 case TypeEnum::Bool: typeName = "Bool"; break;
                 case TypeEnum::Char: typeName = "Char"; break;
@@ -102,34 +317,14 @@ namespace Solar {
                 case TypeEnum::UserType: typeName = "UserType"; break;
             }
 
-            return typeName + (this->extra != "" ? "(" + this->extra + ")" : "");
+            return typeName + (info.extra != InvalidSymbol ? "(" + symbolName(info.extra) + ")" : "");
         }
-
-        Type(TypeEnum kind = TypeEnum::Unknow, bool pointer = false, string extra = "", vector<Type> generics = {}, vector<vector<Type>> unsizedGenerics = {})
-        : kind(kind), extra(extra), isPointer(pointer), primaryType(true), generics(generics), unsizedGenerics(unsizedGenerics) {
-            switch (kind) {
-                case TypeEnum::Null: this->family = "Void"; break;
-                case TypeEnum::Bool: this->family = "Bool"; break;
-                case TypeEnum::Int: this->family = "Number"; break;
-                case TypeEnum::Double: this->family = "Double"; break;
-                case TypeEnum::Float: this->family = "Number"; break;
-                case TypeEnum::Char: this->family = "Alfa"; break;
-                case TypeEnum::Function: this->family = "Function"; break;
-
-                case TypeEnum::Auto: // Same unknow
-                case TypeEnum::Unknow: this->family = "None"; break;
-
-                default: {
-                    this->family = "Custom";
-                    this->primaryType = false;
-                    break;
-                }
-            }
-        };
     };
 
-    inline bool operator==(const Type& a, const Type& b) {
-        return a.compare(b);
+    // Shared by every stage, a TypeId is valid for the whole process
+    inline TypeTable& typeTable() {
+        static TypeTable table;
+        return table;
     }
 
 }
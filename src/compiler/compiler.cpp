@@ -7,6 +7,8 @@
 //////////////
 
 #include "compiler.hpp"
+#include "parallel.hpp"
+#include <cstdio>
 
 using namespace std;
 
@@ -16,70 +18,215 @@ using namespace std;
 
 namespace Solar {
 
+    // Lowering of every OpCode, indexed by it. `integer` is used for int, char and bool
+    // operands and `floating` for float and double; arithmetic and logical entries
+    // hold an Instruction::BinaryOps, comparisons a CmpInst::Predicate (made unsigned for bool).
+    // Pow, Neg and Not only take the name, they are special cased.
+    struct OpLowering {
+        unsigned integer;
+        unsigned floating;
+        const char* name;
+    };
+
+    static const array<OpLowering, OpCodeCount> OpLowerings = {{
+        /* Add */ {llvm::Instruction::Add, llvm::Instruction::FAdd, "addtmp"},
+        /* Sub */ {llvm::Instruction::Sub, llvm::Instruction::FSub, "subtmp"},
+        /* Mul */ {llvm::Instruction::Mul, llvm::Instruction::FMul, "multmp"},
+        /* Div */ {llvm::Instruction::SDiv, llvm::Instruction::FDiv, "divtmp"},
+        /* Mod */ {llvm::Instruction::SRem, llvm::Instruction::FRem, "modtmp"},
+        /* Pow */ {0, 0, "powtmp"},
+
+        /* And */ {llvm::Instruction::And, llvm::Instruction::And, "andtmp"},
+        /* Or  */ {llvm::Instruction::Or, llvm::Instruction::Or, "ortmp"},
+
+        /* Eq */ {llvm::CmpInst::ICMP_EQ, llvm::CmpInst::FCMP_OEQ, "eqtmp"},
+        /* Ne */ {llvm::CmpInst::ICMP_NE, llvm::CmpInst::FCMP_UNE, "netmp"},
+        /* Lt */ {llvm::CmpInst::ICMP_SLT, llvm::CmpInst::FCMP_OLT, "lttmp"},
+        /* Le */ {llvm::CmpInst::ICMP_SLE, llvm::CmpInst::FCMP_OLE, "letmp"},
+        /* Gt */ {llvm::CmpInst::ICMP_SGT, llvm::CmpInst::FCMP_OGT, "gttmp"},
+        /* Ge */ {llvm::CmpInst::ICMP_SGE, llvm::CmpInst::FCMP_OGE, "getmp"},
+
+        /* Neg */ {0, 0, "negtmp"},
+        /* Not */ {0, 0, "nottmp"},
+    }};
+
     // Initializers //
-    void Compiler::compileCode(string code) {
-        Solar::Parser parser;
-        auto block = parser.parseCode(code);
-        cout << block->debug();
-        this->visitBlock(block);
-
-        std::error_code EC;
-        llvm::raw_fd_ostream outFile("../output.ll", EC);
-        this->module->print(llvm::errs(), nullptr);
-        this->module->print(outFile, nullptr);
+    void Compiler::compileCode(const SourceManager& sources, FileId file) {
+        this->buildModule(sources, file);
+        this->writeOutput();
+    }
+
+    void Compiler::buildModule(const SourceManager& sources, FileId file) {
+        AstArena arena;
+        Solar::Parser parser(sources, this->options.lazyBodies);
+        BlockStmt* block = nullptr;
+
+        // A hit skips lexing and parsing, lazy parses are partial and never stored
+        if (!this->options.cacheDir.empty()) {
+            AstCache cache(this->options.cacheDir);
+            block = cache.load(sources, file, arena);
+
+            if (!block) {
+                block = parser.parseCode(file, arena, workerCount() > 1);
+                if (!this->options.lazyBodies) cache.store(sources, file, block);
+            }
+        } else {
+            block = parser.parseCode(file, arena, workerCount() > 1);
+        }
+
+        Sema sema(sources);
+        sema.check(block);
+
+        FlatAst ast(block);
+        this->ast = &ast;
+
+        if (this->options.dumps) cout << ast.debug(ast.root);
+
+        // Prototypes first, a body may call a function declared after it
+        for (NodeId stmt : ast.getChildren(ast.root)) {
+            if (ast.kinds[stmt] == NodeType::FuncStmt) this->declareFunc(stmt);
+        }
+
+        if (this->options.lazyBodies) {
+            this->compileReachable(block, ast, parser, sema, arena);
+        } else {
+            this->visitBlock(ast.root);
+        }
+        this->ast = nullptr;
+
+        // The passes are tuned for the target when there is one, it has to be set before they run
+        if (this->options.emit != EmitKind::IR) {
+            this->machine = createHostMachine(this->options.machine, this->options.pipeline.level);
+            this->module->setTargetTriple(this->machine->getTargetTriple().str());
+            this->module->setDataLayout(this->machine->createDataLayout());
+        }
+
+        optimizeModule(*this->module, this->options.pipeline, this->machine.get());
+
+        if (this->options.dumps) this->module->print(llvm::errs(), nullptr);
+    }
+
+    pair<unique_ptr<llvm::LLVMContext>, unique_ptr<llvm::Module>> Compiler::releaseModule() {
+        return {move(this->ownedContext), move(this->module)};
+    }
+
+    // Lazy mode //
+    void Compiler::compileReachable(BlockStmt* block, FlatAst& ast, Parser& parser, Sema& sema, AstArena& arena) {
+        // Flattening a body appends to `ast`, copy the ids out before it grows
+        auto rootChildren = ast.getChildren(ast.root);
+        vector<NodeId> topLevel(rootChildren.begin(), rootChildren.end());
+        static const Symbol mainName = symbols().intern("main");
+
+        for (size_t i = 0; i < topLevel.size(); i++) {
+            if (ast.kinds[topLevel[i]] == NodeType::FuncStmt) {
+                this->unreached[ast.names[topLevel[i]]] = {static_cast<FuncStmt*>(block->body[i]), topLevel[i]};
+            }
+        }
+
+        // Roots are emitted where they are declared, everything else once a call reaches it
+        for (size_t i = 0; i < topLevel.size(); i++) {
+            if (ast.kinds[topLevel[i]] != NodeType::FuncStmt) {
+                this->compile(topLevel[i]);
+                continue;
+            }
+
+            auto func = static_cast<FuncStmt*>(block->body[i]);
+            if (func->identifier == mainName || func->exported) this->require(func->identifier);
+
+            while (!this->worklist.empty()) {
+                auto [pending, node] = this->worklist.back();
+                this->worklist.pop_back();
+
+                if (pending->lazyBody) {
+                    parser.parseBody(pending, arena);
+                    sema.checkBody(pending);
+                    node = ast.add(pending);
+                }
+
+                this->visitFunc(node);
+            }
+        }
+
+        // Prototypes nothing called
+        for (auto& [name, unused] : this->unreached) {
+            auto func = this->functions[name];
+            if (func->use_empty()) {
+                func->eraseFromParent();
+                this->functions.erase(name);
+            }
+        }
+        this->unreached.clear();
+    }
+
+    void Compiler::require(Symbol name) {
+        auto it = this->unreached.find(name);
+        if (it == this->unreached.end()) return;
+
+        this->worklist.push_back(it->second);
+        this->unreached.erase(it);
     }
 
     // Statments //
-    void Compiler::compile(StmtPtr node) {
-        switch (node->getKind()) {
+    void Compiler::compile(NodeId node) {
+        switch (this->ast->kinds[node]) {
             case NodeType::BlockStmt:
-                this->visitBlock(static_pointer_cast<BlockStmt>(node));
+                this->visitBlock(node);
                 break;
             case NodeType::FuncStmt:
-                this->visitFunc(static_pointer_cast<FuncStmt>(node));
+                this->visitFunc(node);
                 break;
             case NodeType::ReturnStmt:
-                this->visitReturn(static_pointer_cast<ReturnStmt>(node));
+                this->visitReturn(node);
                 break;
             case NodeType::VarDecStmt:
-                this->visitVarDecl(static_pointer_cast<VarDecStmt>(node));
+                this->visitVarDecl(node);
                 break;
 
             default:
-                this->visitExpr(static_pointer_cast<Expr>(node));
+                this->visitExpr(node);
                 break;
         }
     }
 
-    void Compiler::visitBlock(shared_ptr<BlockStmt> node) {
-        for (StmtPtr stmt : node->body) {
+    void Compiler::visitBlock(NodeId node) {
+        for (NodeId stmt : this->ast->getChildren(node)) {
             this->compile(stmt);
         }
     }
 
-    void Compiler::visitFunc(shared_ptr<FuncStmt> node) {
-        auto returnType = this->typeMap[node->returnType.kind];
+    llvm::Function* Compiler::declareFunc(NodeId node) {
+        auto returnType = this->typeMap[typeTable().kind(this->ast->types[node])];
+        Symbol identifier = this->ast->names[node];
 
         vector<llvm::Type*> argTypes;
-        for (const auto& param : node->args) {
-            argTypes.push_back(this->typeMap[param.second.kind]);
+        for (auto param = this->ast->paramsBegin(node); param != this->ast->paramsEnd(node); ++param) {
+            argTypes.push_back(this->typeMap[typeTable().kind(param->type)]);
         }
 
         auto funcType = llvm::FunctionType::get(returnType, argTypes, false);
-        auto func = llvm::Function::Create(funcType, llvm::Function::ExternalLinkage, node->identifier, this->module);
+        auto func = llvm::Function::Create(funcType, llvm::Function::ExternalLinkage, symbols().name(identifier), this->module.get());
+        this->functions[identifier] = func;
+
+        return func;
+    }
+
+    void Compiler::visitFunc(NodeId node) {
+        auto declared = this->functions.find(this->ast->names[node]);
+        bool hasPrototype = declared != this->functions.end() && declared->second->empty();
+        auto func = hasPrototype ? declared->second : this->declareFunc(node);
+        auto returnType = func->getReturnType();
 
         auto entryBlock = llvm::BasicBlock::Create(this->context, "entry", func);
         this->builder.SetInsertPoint(entryBlock);
 
         auto argsIt = func->arg_begin();
-        for (auto& [name, type] : node->args) {
-            argsIt->setName(name);
-            this->namedValues[name] = argsIt;
+        for (auto param = this->ast->paramsBegin(node); param != this->ast->paramsEnd(node); ++param) {
+            argsIt->setName(symbols().name(param->name));
+            this->namedValues[param->name] = argsIt;
             ++argsIt;
         }
-        
 
-        for (const auto& stmt : node->body) {
+        for (NodeId stmt : this->ast->getChildren(node)) {
             this->compile(stmt);
         }
 
@@ -93,16 +240,18 @@ namespace Solar {
         }
     }
 
-    void Compiler::visitReturn(shared_ptr<ReturnStmt> node) {
-        auto value = this->visitExpr(node->ret);
+    void Compiler::visitReturn(NodeId node) {
+        NodeId ret = this->ast->getChild(node);
+        auto value = this->visitExpr(ret);
 
-        if (auto identNode = dynamic_cast<IdentExpr*>(node->ret.get())) {
-            auto varIt = this->namedValues.find(identNode->value);
+        if (this->ast->kinds[ret] == NodeType::IdentExpr) {
+            Symbol name = this->ast->names[ret];
+            auto varIt = this->namedValues.find(name);
             if (varIt != this->namedValues.end()) {
                 llvm::Value* var = varIt->second;
 
                 if (llvm::AllocaInst* allocaInst = llvm::dyn_cast<llvm::AllocaInst>(var)) {
-                    value = this->builder.CreateLoad(allocaInst->getAllocatedType(), var, identNode->value);
+                    value = this->builder.CreateLoad(allocaInst->getAllocatedType(), var, symbols().name(name));
                 }
             }
         }
@@ -110,43 +259,46 @@ namespace Solar {
         this->builder.CreateRet(value);
     }
 
-    void Compiler::visitVarDecl(shared_ptr<VarDecStmt> node) {
-        auto type = this->typeMap[node->value->type_.kind];
+    void Compiler::visitVarDecl(NodeId node) {
+        const TypeInfo& valueType = typeTable().get(this->ast->types[node]);
+        auto type = this->typeMap[valueType.kind];
+        Symbol identifier = this->ast->names[node];
+        NodeId valueNode = this->ast->getChild(node);
 
-        if (node->value->type_.isPointer) {
-            auto value = this->visitExpr(node->value);
-            this->namedValues[node->identifier] = value;
+        if (valueType.isPointer) {
+            auto value = this->visitExpr(valueNode);
+            this->namedValues[identifier] = value;
         } else {
-            auto var = this->builder.CreateAlloca(type, nullptr, node->identifier);
-            this->namedValues[node->identifier] = var;
+            auto var = this->builder.CreateAlloca(type, nullptr, symbols().name(identifier));
+            this->namedValues[identifier] = var;
 
-            if (node->value != nullptr) {
-                auto value = this->visitExpr(node->value);
+            if (valueNode != InvalidNode) {
+                auto value = this->visitExpr(valueNode);
                 this->builder.CreateStore(value, var);
             }
         }
     }
 
     // Expressions //
-    llvm::Value* Compiler::visitExpr(ExprPtr node) {
-        switch (node->getKind()) {
+    llvm::Value* Compiler::visitExpr(NodeId node) {
+        switch (this->ast->kinds[node]) {
             case NodeType::AssignmentExpr:
-                return this->visitAssignExpr(static_pointer_cast<AssignmentExpr>(node));
+                return this->visitAssignExpr(node);
                 break;
             case NodeType::LogicalExpr:
-                return this->visitLogicalExpr(static_pointer_cast<LogicalExpr>(node));
+                return this->visitLogicalExpr(node);
                 break;
             case NodeType::ComparasonExpr:
-                return this->visitCompareExpr(static_pointer_cast<ComparasonExpr>(node));
+                return this->visitCompareExpr(node);
                 break;
             case NodeType::BinaryExpr:
-                return this->visitBinaryExpr(static_pointer_cast<BinaryExpr>(node));
+                return this->visitBinaryExpr(node);
                 break;
             case NodeType::UnaryExpr:
-                return this->visitUnaryExpr(static_pointer_cast<UnaryExpr>(node));
+                return this->visitUnaryExpr(node);
                 break;
             case NodeType::CallExpr:
-                return this->visitCallExpr(static_pointer_cast<CallExpr>(node));
+                return this->visitCallExpr(node);
                 break;
 
             default:
@@ -155,133 +307,136 @@ namespace Solar {
         }
     }
 
-    llvm::Value* Compiler::visitAssignExpr(shared_ptr<AssignmentExpr> node) {
-        auto value = this->visitExpr(node->value);
-        auto var = this->namedValues[node->identifier];
+    llvm::Value* Compiler::visitAssignExpr(NodeId node) {
+        auto value = this->visitExpr(this->ast->getChild(node));
+        auto var = this->namedValues[this->ast->names[node]];
 
         return this->builder.CreateStore(value, var);
     }
 
-    llvm::Value* Compiler::visitCallExpr(shared_ptr<CallExpr> node) {
+    llvm::Value* Compiler::visitCallExpr(NodeId node) {
         llvm::FunctionCallee func;
+        auto nodeChildren = this->ast->getChildren(node);
 
-        if (node->isExpr) {
+        if (this->ast->payloads[node]) {
             cout << "I dont implement this" << endl;
         } else {
-            func = this->module->getFunction(static_pointer_cast<IdentExpr>(node->left)->value);
+            Symbol callee = this->ast->names[nodeChildren[0]];
+            func = this->functions[callee];
+
+            if (this->options.lazyBodies) this->require(callee);
         }
 
         vector<llvm::Value*> args;
-        for (const auto& arg : node->args) {
-            args.push_back(this->visitExpr(arg));
+        for (size_t i = 1; i < nodeChildren.size(); i++) {
+            args.push_back(this->visitExpr(nodeChildren[i]));
         }
 
         return this->builder.CreateCall(func, args, "calltmp");
     }
 
-    llvm::Value* Compiler::visitLogicalExpr(shared_ptr<LogicalExpr> node) {
-        auto left = this->visitExpr(node->left);
-        auto right = this->visitExpr(node->right);
+    llvm::Value* Compiler::visitLogicalExpr(NodeId node) {
+        auto left = this->visitExpr(this->ast->getChild(node, 0));
+        auto right = this->visitExpr(this->ast->getChild(node, 1));
+        const OpLowering& lowering = OpLowerings[static_cast<size_t>(this->ast->getOp(node))];
 
-        if (node->op == "&&") {
-            return this->builder.CreateAnd(left, right, "andtmp");
-        } else if (node->op == "||") {
-            return this->builder.CreateOr(left, right, "ortmp");
-        } else {
-            return llvm::Constant::getNullValue(llvm::Type::getVoidTy(this->context));
+        return this->builder.CreateBinOp(static_cast<llvm::Instruction::BinaryOps>(lowering.integer), left, right, lowering.name);
+    }
+
+    llvm::Value* Compiler::visitCompareExpr(NodeId node) {
+        auto left = this->visitExpr(this->ast->getChild(node, 0));
+        auto right = this->visitExpr(this->ast->getChild(node, 1));
+        const OpLowering& lowering = OpLowerings[static_cast<size_t>(this->ast->getOp(node))];
+
+        auto predicate = static_cast<llvm::CmpInst::Predicate>(left->getType()->isFloatingPointTy() ? lowering.floating : lowering.integer);
+
+        // false orders before true, a signed predicate reads an i1 true as -1
+        if (left->getType()->isIntegerTy(1) && llvm::CmpInst::isSigned(predicate)) {
+            predicate = llvm::ICmpInst::getUnsignedPredicate(predicate);
         }
+
+        return this->builder.CreateCmp(predicate, left, right, lowering.name);
     }
 
-    llvm::Value* Compiler::visitCompareExpr(shared_ptr<ComparasonExpr> node) {
-        auto left = this->visitExpr(node->left);
-        auto right = this->visitExpr(node->right);
-
-        if (node->op == "==") {
-            return this->builder.CreateICmpEQ(left, right, "eqtmp");
-        } else if (node->op == "!=") {
-            return this->builder.CreateICmpNE(left, right, "netmp");
-        } else if (node->op == ">") {
-            return this->builder.CreateICmpSGT(left, right, "gttmp");
-        } else if (node->op == "<") {
-            return this->builder.CreateICmpSLT(left, right, "lttmp");
-        } else if (node->op == ">=") {
-            return this->builder.CreateICmpSGE(left, right, "getmp");
-        } else if (node->op == "<=") {
-            return this->builder.CreateICmpSLE(left, right, "letmp");
-        } else {
-            return llvm::Constant::getNullValue(llvm::Type::getVoidTy(this->context));
+    llvm::Value* Compiler::visitBinaryExpr(NodeId node) {
+        auto left = this->visitExpr(this->ast->getChild(node, 0));
+        auto right = this->visitExpr(this->ast->getChild(node, 1));
+        OpCode op = this->ast->getOp(node);
+
+        if (op == OpCode::Pow) {
+            return this->emitPow(left, right);
         }
+
+        const OpLowering& lowering = OpLowerings[static_cast<size_t>(op)];
+        unsigned instruction = left->getType()->isFloatingPointTy() ? lowering.floating : lowering.integer;
+
+        return this->builder.CreateBinOp(static_cast<llvm::Instruction::BinaryOps>(instruction), left, right, lowering.name);
     }
 
-    llvm::Value* Compiler::visitBinaryExpr(shared_ptr<BinaryExpr> node) {
-        auto left = this->visitExpr(node->left);
-        auto right = this->visitExpr(node->right);
-
-        if (node->op == "+") {
-            return this->builder.CreateAdd(left, right, "addtmp");
-        } else if (node->op == "-") {
-            return this->builder.CreateSub(left, right, "subtmp");
-        } else if (node->op == "*") {
-            return this->builder.CreateMul(left, right, "multmp");
-        } else if (node->op == "/") {
-            return this->builder.CreateSDiv(left, right, "divtmp");
-        } else if (node->op == "%") {
-            return this->builder.CreateSRem(left, right, "modtmp");
-        } else if (node->op == "^") {
-            llvm::Function *powFunction = llvm::Intrinsic::getDeclaration(
-                this->module, llvm::Intrinsic::pow, {llvm::Type::getDoubleTy(this->context), llvm::Type::getDoubleTy(this->context)}
-            );
-            return this->builder.CreateCall(powFunction, {left, right}, "powtmp");
-        } else {
-            return llvm::Constant::getNullValue(llvm::Type::getVoidTy(this->context));
+    llvm::Value* Compiler::visitUnaryExpr(NodeId node) {
+        auto expr = this->visitExpr(this->ast->getChild(node));
+        OpCode op = this->ast->getOp(node);
+        const char* name = OpLowerings[static_cast<size_t>(op)].name;
+
+        if (op == OpCode::Not) {
+            return this->builder.CreateNot(expr, name);
         }
+
+        return expr->getType()->isFloatingPointTy() ? this->builder.CreateFNeg(expr, name) : this->builder.CreateNeg(expr, name);
     }
 
-    llvm::Value* Compiler::visitUnaryExpr(shared_ptr<UnaryExpr> node) {
-        auto expr = this->visitExpr(node->value);
+    llvm::Value* Compiler::emitPow(llvm::Value* base, llvm::Value* exponent) {
+        auto type = base->getType();
 
-        if (node->op == "-") {
-            return this->builder.CreateNeg(expr, "negtmp");
-        } else if (node->op == "!") {
-            return this->builder.CreateNot(expr, "nottmp");
-        } else {
-            return llvm::Constant::getNullValue(llvm::Type::getVoidTy(this->context));
+        if (type->isFloatingPointTy()) {
+            auto powFunction = llvm::Intrinsic::getDeclaration(this->module.get(), llvm::Intrinsic::pow, {type});
+            return this->builder.CreateCall(powFunction, {base, exponent}, "powtmp");
         }
+
+        // There is no integer pow intrinsic, go through double and truncate back
+        auto doubleType = llvm::Type::getDoubleTy(this->context);
+        auto powFunction = llvm::Intrinsic::getDeclaration(this->module.get(), llvm::Intrinsic::pow, {doubleType});
+        auto result = this->builder.CreateCall(powFunction, {
+            this->builder.CreateSIToFP(base, doubleType),
+            this->builder.CreateSIToFP(exponent, doubleType)
+        }, "powtmp");
+
+        return this->builder.CreateFPToSI(result, type);
     }
 
-    llvm::Value* Compiler::visitPrimaryExpr(ExprPtr node) {
-        switch (node->getKind()) {
+    llvm::Value* Compiler::visitPrimaryExpr(NodeId node) {
+        switch (this->ast->kinds[node]) {
             case NodeType::NullExpr: {
                 return llvm::Constant::getNullValue(llvm::Type::getVoidTy(this->context));
             }
             case NodeType::BoolExpr: {
-                bool value = static_cast<BoolExpr*>(node.get())->value;
+                bool value = this->ast->payloads[node] != 0;
                 return llvm::ConstantInt::get(llvm::Type::getInt1Ty(this->context), value);
             }
             case NodeType::IntExpr: {
-                int value = static_cast<IntExpr*>(node.get())->value;
+                int value = static_cast<int>(this->ast->payloads[node]);
                 return llvm::ConstantInt::get(llvm::Type::getInt32Ty(this->context), value);
             }
             case NodeType::DoubleExpr: {
-                double value = static_cast<DoubleExpr*>(node.get())->value;
+                double value = this->ast->getDouble(node);
                 return llvm::ConstantFP::get(llvm::Type::getDoubleTy(this->context), value);
             }
             case NodeType::FloatExpr: {
-                double value = static_cast<FloatExpr*>(node.get())->value;
+                double value = this->ast->getFloat(node);
                 return llvm::ConstantFP::get(llvm::Type::getFloatTy(this->context), value);
             }
             case NodeType::CharExpr: {
-                char value = static_cast<CharExpr*>(node.get())->value;
+                char value = static_cast<char>(this->ast->payloads[node]);
                 return llvm::ConstantInt::get(llvm::Type::getInt8Ty(this->context), value);
             }
             case NodeType::IdentExpr: {
-                auto identNode = static_pointer_cast<IdentExpr>(node);
-                auto varIt = this->namedValues.find(identNode->value);
+                Symbol name = this->ast->names[node];
+                auto varIt = this->namedValues.find(name);
 
                 llvm::Value* var = varIt->second;
 
                 if (llvm::AllocaInst* allocaInst = llvm::dyn_cast<llvm::AllocaInst>(var)) {
-                    return this->builder.CreateLoad(allocaInst->getAllocatedType(), var, identNode->value);
+                    return this->builder.CreateLoad(allocaInst->getAllocatedType(), var, symbols().name(name));
                 }
 
                 return var;
@@ -292,4 +447,37 @@ namespace Solar {
         }
     }
 
+    // Output //
+    void Compiler::writeOutput() {
+        EmitKind kind = this->options.emit;
+        string path = this->options.outputPath.empty() ? "../output" + string(emitExtension(kind)) : this->options.outputPath;
+
+        switch (kind) {
+            case EmitKind::IR: {
+                std::error_code EC;
+                llvm::raw_fd_ostream outFile(path, EC);
+                this->module->print(outFile, nullptr);
+                break;
+            }
+            case EmitKind::Assembly:
+            case EmitKind::Object:
+                emitNative(*this->module, *this->machine, kind, path);
+                break;
+            case EmitKind::Executable: {
+                // The object only lives until the driver linked it
+                string objectPath = path + ".o";
+                emitNative(*this->module, *this->machine, EmitKind::Object, objectPath);
+
+                try {
+                    linkExecutable(objectPath, path);
+                } catch (...) {
+                    remove(objectPath.c_str());
+                    throw;
+                }
+                remove(objectPath.c_str());
+                break;
+            }
+        }
+    }
+
 }
\ No newline at end of file
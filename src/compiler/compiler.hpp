@@ -9,7 +9,14 @@
 #pragma once
 
 #include "ast/pack.hpp"
+#include "optimizer.hpp"
+#include "target.hpp"
+#include <array>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/IRBuilder.h>
@@ -23,35 +30,69 @@ using namespace std;
 
 namespace Solar {
 
+    struct CompileOptions {
+        // Only functions reachable from `main` or an `export func` are parsed, checked and emitted
+        bool lazyBodies = false;
+        // Where parsed trees are cached by source hash, and JIT objects by module IR; empty to always parse and compile
+        string cacheDir;
+        // LLVM passes run on the module before it is printed
+        PipelineOptions pipeline;
+        // What is written, to `outputPath` or ../output with the kind's extension
+        EmitKind emit = EmitKind::IR;
+        string outputPath;
+        // Host machine code is generated for, unused for IR
+        MachineOptions machine;
+        // Prints the checked tree to stdout and the final IR to stderr
+        bool dumps = true;
+    };
+
     class Compiler {
     private:
-        llvm::LLVMContext context;
-        llvm::Module* module;
+        CompileOptions options;
+        unique_ptr<llvm::LLVMContext> ownedContext; // Leaves with the module in releaseModule
+        llvm::LLVMContext& context;
+        unique_ptr<llvm::Module> module;
+        unique_ptr<llvm::TargetMachine> machine; // Only for native output
         llvm::IRBuilder<> builder;
         unordered_map<TypeEnum, llvm::Type*> typeMap;
-        unordered_map<string, llvm::Value*> namedValues;
+        unordered_map<Symbol, llvm::Value*> namedValues;
+        unordered_map<Symbol, llvm::Function*> functions;
+        const FlatAst* ast = nullptr; // Tree being compiled
+
+        // Lazy mode //
+        unordered_map<Symbol, pair<FuncStmt*, NodeId>> unreached; // Top-level functions not queued yet
+        vector<pair<FuncStmt*, NodeId>> worklist;
+
+        void compileReachable(BlockStmt* block, FlatAst& ast, Parser& parser, Sema& sema, AstArena& arena);
+        void require(Symbol name);
 
         // Statments //
-        void compile(StmtPtr node);
-        void visitBlock(shared_ptr<BlockStmt> node);
-        void visitFunc(shared_ptr<FuncStmt> node);
-        void visitReturn(shared_ptr<ReturnStmt> node);
-        void visitVarDecl(shared_ptr<VarDecStmt> node);
+        void compile(NodeId node);
+        void visitBlock(NodeId node);
+        llvm::Function* declareFunc(NodeId node);
+        void visitFunc(NodeId node);
+        void visitReturn(NodeId node);
+        void visitVarDecl(NodeId node);
 
         // Expressions //
-        llvm::Value* visitExpr(ExprPtr node);
+        llvm::Value* visitExpr(NodeId node);
 
-        llvm::Value* visitAssignExpr(shared_ptr<AssignmentExpr> node);
-        llvm::Value* visitCallExpr(shared_ptr<CallExpr> node);
+        llvm::Value* visitAssignExpr(NodeId node);
+        llvm::Value* visitCallExpr(NodeId node);
 
-        llvm::Value* visitLogicalExpr(shared_ptr<LogicalExpr> node);
-        llvm::Value* visitCompareExpr(shared_ptr<ComparasonExpr> node);
-        llvm::Value* visitBinaryExpr(shared_ptr<BinaryExpr> node);
-        llvm::Value* visitUnaryExpr(shared_ptr<UnaryExpr> node);
+        llvm::Value* visitLogicalExpr(NodeId node);
+        llvm::Value* visitCompareExpr(NodeId node);
+        llvm::Value* visitBinaryExpr(NodeId node);
+        llvm::Value* visitUnaryExpr(NodeId node);
+        llvm::Value* emitPow(llvm::Value* base, llvm::Value* exponent);
 
-        llvm::Value* visitPrimaryExpr(ExprPtr node);
+        llvm::Value* visitPrimaryExpr(NodeId node);
+
+        // Output //
+        void writeOutput();
     public:
-        Compiler() : module(new llvm::Module("Main", context)), builder(llvm::IRBuilder<>(context)) {
+        Compiler(CompileOptions options = CompileOptions()) : options(options), ownedContext(make_unique<llvm::LLVMContext>()), context(*ownedContext),
+            module(make_unique<llvm::Module>("Main", context)), builder(llvm::IRBuilder<>(context)) {
             this->typeMap[TypeEnum::Null] = llvm::Type::getVoidTy(context);
             this->typeMap[TypeEnum::Bool] = llvm::Type::getInt1Ty(context);
             this->typeMap[TypeEnum::Int] = llvm::Type::getInt32Ty(context);
@@ -60,7 +101,14 @@ namespace Solar {
             this->typeMap[TypeEnum::Char] = llvm::Type::getInt8Ty(context);
         }
 
-        void compileCode(string code);
+        // Builds the module and writes it out as the options ask
+        void compileCode(const SourceManager& sources, FileId file);
+
+        // Parses, checks, generates and optimizes the module without writing anything
+        void buildModule(const SourceManager& sources, FileId file);
+
+        // Hands the built module over with the context it lives in, the compiler is done after it
+        pair<unique_ptr<llvm::LLVMContext>, unique_ptr<llvm::Module>> releaseModule();
     };
 
 }
\ No newline at end of file
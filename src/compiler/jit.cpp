@@ -0,0 +1,106 @@
+/***
+ * @file jit.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "jit.hpp"
+#include "target.hpp"
+#include "objcache.hpp"
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/TargetSelect.h>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+    template <typename T>
+    static T unwrap(llvm::Expected<T> value, const char* what) {
+        if (!value) throw runtime_error(string(what) + ": " + llvm::toString(value.takeError()));
+        return move(*value);
+    }
+
+    static void check(llvm::Error error, const char* what) {
+        if (error) throw runtime_error(string(what) + ": " + llvm::toString(move(error)));
+    }
+
+    static double millisecondsSince(chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    RunResult runMain(unique_ptr<llvm::LLVMContext> context, unique_ptr<llvm::Module> module, OptLevel level, const string& cacheDir) {
+        // main's type decides how it is called, the module is gone once the JIT owns it
+        auto mainFunc = module->getFunction("main");
+        if (!mainFunc || mainFunc->isDeclaration()) throw runtime_error("Nothing to run, there is no main function");
+
+        auto returnType = mainFunc->getReturnType();
+        if (mainFunc->arg_size() != 0 || !(returnType->isVoidTy() || returnType->isIntegerTy(32) || returnType->isIntegerTy(8) || returnType->isIntegerTy(1))) {
+            throw runtime_error("main must take no arguments and return int, char, bool or null to be run");
+        }
+
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        auto machineBuilder = unwrap(llvm::orc::JITTargetMachineBuilder::detectHost(), "Can't detect the host");
+        machineBuilder.setCodeGenOptLevel(codeGenLevel(level));
+
+        // The cache is keyed on the host CPU and features detectHost picked, so objects never cross machines
+        unique_ptr<ObjectFileCache> cache;
+        if (!cacheDir.empty()) {
+            string target = machineBuilder.getTargetTriple().str() + "|" + machineBuilder.getCPU() + "|"
+                + machineBuilder.getFeatures().getString() + "|codegen " + to_string(static_cast<int>(codeGenLevel(level)));
+            cache = make_unique<ObjectFileCache>(cacheDir, move(target));
+        }
+
+        llvm::orc::LLJITBuilder jitBuilder;
+        jitBuilder.setJITTargetMachineBuilder(move(machineBuilder));
+
+        if (cache) {
+            jitBuilder.setCompileFunctionCreator([&cache](llvm::orc::JITTargetMachineBuilder targetBuilder)
+                -> llvm::Expected<unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+                return make_unique<llvm::orc::ConcurrentIRCompiler>(move(targetBuilder), cache.get());
+            });
+        }
+
+        auto jit = unwrap(jitBuilder.create(), "Can't create the JIT");
+        auto& mainLib = jit->getMainJITDylib();
+        mainLib.addGenerator(unwrap(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit->getDataLayout().getGlobalPrefix()), "Can't search the process symbols"));
+
+        // The lookup is what compiles, or loads from the cache: LLJIT only generates code once a symbol is asked for
+        auto compileStart = chrono::steady_clock::now();
+        check(jit->addIRModule(llvm::orc::ThreadSafeModule(move(module), move(context))), "Can't add the module");
+        auto address = unwrap(jit->lookup("main"), "Can't compile main").getAddress();
+        double compileMs = millisecondsSince(compileStart);
+
+        auto runStart = chrono::steady_clock::now();
+        int exitCode = 0;
+
+        if (returnType->isVoidTy()) {
+            reinterpret_cast<void (*)()>(address)();
+        } else if (returnType->isIntegerTy(32)) {
+            exitCode = reinterpret_cast<int32_t (*)()>(address)();
+        } else if (returnType->isIntegerTy(8)) {
+            exitCode = reinterpret_cast<int8_t (*)()>(address)();
+        } else {
+            exitCode = reinterpret_cast<bool (*)()>(address)();
+        }
+
+        return {exitCode, compileMs, millisecondsSince(runStart), cache && cache->getHits() > 0};
+    }
+
+}
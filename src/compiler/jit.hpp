@@ -0,0 +1,38 @@
+/***
+ * @file jit.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "optimizer.hpp"
+#include <memory>
+#include <string>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    struct RunResult {
+        int exitCode;     // What main returned, 0 when it returns nothing
+        double compileMs; // Machine code generation and linking in memory
+        double runMs;     // The call to main
+        bool cached;      // The machine code came from the object cache
+    };
+
+    // Compiles `module` in-process with ORC's LLJIT and calls its `main`. Symbols the module
+    // doesn't define, like libm's pow, resolve against the running process. Throws when the
+    // JIT can't be set up or `main` is missing or returns something other than int, char, bool or null.
+    // With a `cacheDir` the machine code is kept there and reused by later runs of the same module
+    RunResult runMain(unique_ptr<llvm::LLVMContext> context, unique_ptr<llvm::Module> module, OptLevel level, const string& cacheDir = "");
+
+}
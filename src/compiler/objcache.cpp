@@ -0,0 +1,128 @@
+/***
+ * @file objcache.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "objcache.hpp"
+#include "ast/cache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <llvm/BinaryFormat/Magic.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+    static void appendWord(string& out, uint32_t value) {
+        char bytes[sizeof(value)];
+        memcpy(bytes, &value, sizeof(value));
+        out.append(bytes, sizeof(value));
+    }
+
+    static bool readWord(llvm::StringRef& in, uint32_t& value) {
+        if (in.size() < sizeof(value)) return false;
+
+        memcpy(&value, in.data(), sizeof(value));
+        in = in.drop_front(sizeof(value));
+        return true;
+    }
+
+    string ObjectFileCache::keyFor(const llvm::Module* module) const {
+        string ir;
+        llvm::raw_string_ostream irStream(ir);
+        module->print(irStream, nullptr);
+
+        char irHash[17];
+        snprintf(irHash, sizeof(irHash), "%016llx", static_cast<unsigned long long>(hashSource(irStream.str())));
+
+        return this->target + "|llvm " LLVM_VERSION_STRING "|ir " + irHash + "|" + to_string(ir.size());
+    }
+
+    string ObjectFileCache::pathFor(const string& key) const {
+        char name[24];
+        snprintf(name, sizeof(name), "%016llx.sobj", static_cast<unsigned long long>(hashSource(key)));
+
+        return (filesystem::path(this->directory) / name).string();
+    }
+
+    unique_ptr<llvm::MemoryBuffer> ObjectFileCache::getObject(const llvm::Module* module) {
+        string key = this->keyFor(module);
+        lock_guard<mutex> guard(this->lock);
+
+        auto file = llvm::MemoryBuffer::getFile(this->pathFor(key), false, false);
+        if (!file) {
+            this->pending[module] = key;
+            return nullptr;
+        }
+
+        llvm::StringRef contents = (*file)->getBuffer();
+        uint32_t magic, version, keySize;
+
+        bool valid = readWord(contents, magic) && readWord(contents, version) && readWord(contents, keySize)
+            && magic == ObjectCacheMagic && version == ObjectCacheVersion
+            && contents.size() >= keySize && contents.take_front(keySize) == key;
+
+        llvm::StringRef object = valid ? contents.drop_front(keySize) : llvm::StringRef();
+        if (!valid || llvm::identify_magic(object) == llvm::file_magic::unknown) {
+            this->pending[module] = key;
+            return nullptr;
+        }
+
+        this->hits++;
+        return llvm::MemoryBuffer::getMemBufferCopy(object, module->getModuleIdentifier());
+    }
+
+    void ObjectFileCache::notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef object) {
+        lock_guard<mutex> guard(this->lock);
+
+        auto it = this->pending.find(module);
+        if (it == this->pending.end()) return; // Never looked up, the IR it was compiled from is gone
+
+        string key = move(it->second);
+        this->pending.erase(it);
+
+        error_code error;
+        filesystem::create_directories(this->directory, error);
+        if (error) return;
+
+        string header;
+        appendWord(header, ObjectCacheMagic);
+        appendWord(header, ObjectCacheVersion);
+        appendWord(header, static_cast<uint32_t>(key.size()));
+        header += key;
+
+        // Written aside and renamed, a reader never sees half an object. Workers compiling the
+        // same script race on the same name, each writes its own temporary
+        string path = this->pathFor(key);
+        string temporary = path + "." + to_string(llvm::sys::Process::getProcessId()) + ".tmp";
+        {
+            ofstream output(temporary, ios::binary | ios::trunc);
+            if (!output.is_open()) return;
+
+            output.write(header.data(), static_cast<streamsize>(header.size()));
+            output.write(object.getBufferStart(), static_cast<streamsize>(object.getBufferSize()));
+            if (!output) {
+                output.close();
+                filesystem::remove(temporary, error);
+                return;
+            }
+        }
+
+        filesystem::rename(temporary, path, error);
+        if (error) filesystem::remove(temporary, error);
+    }
+
+}
@@ -0,0 +1,61 @@
+/***
+ * @file objcache.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Machine code the JIT compiled, kept on disk so later runs of the same module skip codegen.
+    // Objects are named after a hash of their key: the module's printed IR, the target (triple,
+    // CPU, features and codegen level) and the LLVM version. Every file starts with the key in
+    // full, so a hash collision or a foreign file reads as a miss:
+    //
+    //   magic u32, version u32, keySize u32, key u8[keySize], object u8[]
+    constexpr uint32_t ObjectCacheMagic = 0x4a424f53; // "SOBJ"
+    constexpr uint32_t ObjectCacheVersion = 1;
+
+    class ObjectFileCache : public llvm::ObjectCache {
+    private:
+        string directory;
+        string target; // Part of every key
+        mutex lock;
+        unordered_map<const llvm::Module*, string> pending; // Keys taken before codegen, which rewrites the IR
+        size_t hits = 0;
+
+        string keyFor(const llvm::Module* module) const;
+        string pathFor(const string& key) const;
+
+    public:
+        ObjectFileCache(string directory, string target) : directory(move(directory)), target(move(target)) {}
+
+        // Best effort, a failed write only means the next run compiles again
+        void notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef object) override;
+
+        // Null on a miss
+        unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* module) override;
+
+        size_t getHits() const { return this->hits; }
+    };
+
+}
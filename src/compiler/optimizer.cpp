@@ -0,0 +1,116 @@
+/***
+ * @file optimizer.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "optimizer.hpp"
+#include <stdexcept>
+#include <llvm/ADT/Any.h>
+#include <llvm/Analysis/CGSCCPassManager.h>
+#include <llvm/Analysis/LazyCallGraph.h>
+#include <llvm/Analysis/LoopAnalysisManager.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/IR/PassTimingInfo.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+    static llvm::OptimizationLevel toLLVM(OptLevel level) {
+        switch (level) {
+            case OptLevel::O1: return llvm::OptimizationLevel::O1;
+            case OptLevel::O2: return llvm::OptimizationLevel::O2;
+            case OptLevel::O3: return llvm::OptimizationLevel::O3;
+            case OptLevel::Os: return llvm::OptimizationLevel::Os;
+
+            default: return llvm::OptimizationLevel::O0;
+        }
+    }
+
+    // Managers and adaptors only wrap the passes that do the work, dumping after them repeats the IR
+    static bool isWrapperPass(llvm::StringRef pass) {
+        return pass.contains("PassManager") || pass.contains("PassAdaptor");
+    }
+
+    // Prints the unit a pass ran on, loops and SCCs through the functions holding them
+    static void printUnit(llvm::StringRef pass, llvm::Any unit) {
+        llvm::errs() << "; *** IR Dump After " << pass << " ***\n";
+
+        if (llvm::any_isa<const llvm::Module*>(unit)) {
+            llvm::any_cast<const llvm::Module*>(unit)->print(llvm::errs(), nullptr);
+        } else if (llvm::any_isa<const llvm::Function*>(unit)) {
+            llvm::any_cast<const llvm::Function*>(unit)->print(llvm::errs());
+        } else if (llvm::any_isa<const llvm::LazyCallGraph::SCC*>(unit)) {
+            for (const auto& node : *llvm::any_cast<const llvm::LazyCallGraph::SCC*>(unit)) {
+                node.getFunction().print(llvm::errs());
+            }
+        } else if (llvm::any_isa<const llvm::Loop*>(unit)) {
+            llvm::any_cast<const llvm::Loop*>(unit)->getHeader()->getParent()->print(llvm::errs());
+        }
+    }
+
+    bool parseOptLevel(const string& flag, OptLevel& level) {
+        if (flag == "-O0") level = OptLevel::O0;
+        else if (flag == "-O1") level = OptLevel::O1;
+        else if (flag == "-O2") level = OptLevel::O2;
+        else if (flag == "-O3") level = OptLevel::O3;
+        else if (flag == "-Os") level = OptLevel::Os;
+        else return false;
+
+        return true;
+    }
+
+    void optimizeModule(llvm::Module& module, const PipelineOptions& options, llvm::TargetMachine* machine) {
+        string problems;
+        llvm::raw_string_ostream problemsStream(problems);
+
+        if (llvm::verifyModule(module, &problemsStream)) {
+            throw runtime_error("Generated module is invalid:\n" + problemsStream.str());
+        }
+
+        llvm::PassInstrumentationCallbacks callbacks;
+        llvm::TimePassesHandler timing(options.timePasses);
+        timing.registerCallbacks(callbacks);
+
+        if (options.printAfterAll) {
+            callbacks.registerAfterPassCallback([](llvm::StringRef pass, llvm::Any unit, const llvm::PreservedAnalyses&) {
+                if (!isWrapperPass(pass)) printUnit(pass, unit);
+            });
+        }
+
+        // Analysis managers are declared in this order so they are destroyed in the reverse one
+        llvm::LoopAnalysisManager loops;
+        llvm::FunctionAnalysisManager functions;
+        llvm::CGSCCAnalysisManager sccs;
+        llvm::ModuleAnalysisManager modules;
+
+        llvm::PassBuilder builder(machine, llvm::PipelineTuningOptions(), llvm::None, &callbacks);
+        builder.registerModuleAnalyses(modules);
+        builder.registerCGSCCAnalyses(sccs);
+        builder.registerFunctionAnalyses(functions);
+        builder.registerLoopAnalyses(loops);
+        builder.crossRegisterProxies(loops, functions, sccs, modules);
+
+        auto level = toLLVM(options.level);
+        llvm::ModulePassManager pipeline = options.level == OptLevel::O0
+            ? builder.buildO0DefaultPipeline(level)
+            : builder.buildPerModuleDefaultPipeline(level);
+
+        pipeline.run(module, modules);
+    }
+
+}
@@ -0,0 +1,46 @@
+/***
+ * @file optimizer.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <string>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    enum class OptLevel {
+        O0,
+        O1,
+        O2,
+        O3,
+        Os,
+    };
+
+    // Parses "-O0".."-O3" and "-Os", false for anything else
+    bool parseOptLevel(const string& flag, OptLevel& level);
+
+    struct PipelineOptions {
+        OptLevel level = OptLevel::O0;
+        // Per-pass timing report on stderr once the pipeline finished
+        bool timePasses = false;
+        // Dumps the IR unit every pass ran on to stderr, after the pass
+        bool printAfterAll = false;
+    };
+
+    // Runs LLVM's default pipeline for the level on `module`, tuned for `machine` when there is one.
+    // The module is verified first, the passes assume well-formed IR; throws if it is not
+    void optimizeModule(llvm::Module& module, const PipelineOptions& options, llvm::TargetMachine* machine = nullptr);
+
+}
@@ -1,3 +1,4 @@
 #pragma once
 
-#include "compiler.hpp"
\ No newline at end of file
+#include "compiler.hpp"
+#include "jit.hpp"
\ No newline at end of file
@@ -0,0 +1,126 @@
+/***
+ * @file target.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "target.hpp"
+#include <stdexcept>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetOptions.h>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+    static string hostFeatures() {
+        llvm::StringMap<bool> features;
+        if (!llvm::sys::getHostCPUFeatures(features)) return "";
+
+        string list;
+        for (const auto& feature : features) {
+            if (!list.empty()) list += ',';
+            list += (feature.getValue() ? '+' : '-') + feature.getKey().str();
+        }
+
+        return list;
+    }
+
+    llvm::CodeGenOpt::Level codeGenLevel(OptLevel level) {
+        switch (level) {
+            case OptLevel::O0: return llvm::CodeGenOpt::None;
+            case OptLevel::O1: return llvm::CodeGenOpt::Less;
+            case OptLevel::O3: return llvm::CodeGenOpt::Aggressive;
+
+            default: return llvm::CodeGenOpt::Default;
+        }
+    }
+
+    bool parseEmitKind(const string& name, EmitKind& kind) {
+        if (name == "ir") kind = EmitKind::IR;
+        else if (name == "asm") kind = EmitKind::Assembly;
+        else if (name == "obj") kind = EmitKind::Object;
+        else if (name == "exe") kind = EmitKind::Executable;
+        else return false;
+
+        return true;
+    }
+
+    const char* emitExtension(EmitKind kind) {
+        switch (kind) {
+            case EmitKind::Assembly: return ".s";
+            case EmitKind::Object: return ".o";
+            case EmitKind::Executable: return "";
+
+            default: return ".ll";
+        }
+    }
+
+    unique_ptr<llvm::TargetMachine> createHostMachine(const MachineOptions& options, OptLevel level) {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        string triple = llvm::sys::getDefaultTargetTriple();
+        string error;
+
+        auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+        if (!target) throw runtime_error("No target for " + triple + ": " + error);
+
+        string cpu = options.cpu == "native" ? llvm::sys::getHostCPUName().str() : options.cpu;
+        string features = options.features == "native" ? hostFeatures() : options.features;
+
+        // PIC so the system driver can link a position independent executable
+        auto machine = target->createTargetMachine(triple, cpu, features, llvm::TargetOptions(), llvm::Reloc::PIC_, llvm::None, codeGenLevel(level));
+        if (!machine) throw runtime_error("Can't create a target machine for " + triple + " (" + cpu + ")");
+
+        return unique_ptr<llvm::TargetMachine>(machine);
+    }
+
+    void emitNative(llvm::Module& module, llvm::TargetMachine& machine, EmitKind kind, const string& path) {
+        error_code errorCode;
+        llvm::raw_fd_ostream out(path, errorCode, llvm::sys::fs::OF_None);
+        if (errorCode) throw runtime_error("Can't open " + path + ": " + errorCode.message());
+
+        // Code generation still runs on the legacy pass manager
+        llvm::legacy::PassManager passes;
+        auto fileType = kind == EmitKind::Assembly ? llvm::CGFT_AssemblyFile : llvm::CGFT_ObjectFile;
+
+        if (machine.addPassesToEmitFile(passes, out, nullptr, fileType)) {
+            throw runtime_error("The target can't emit " + string(kind == EmitKind::Assembly ? "assembly" : "object files"));
+        }
+
+        passes.run(module);
+        out.flush();
+    }
+
+    void linkExecutable(const string& objectPath, const string& outputPath) {
+        auto driver = llvm::sys::findProgramByName("cc");
+        if (!driver) throw runtime_error("No system compiler (cc) on PATH to link with");
+
+        // libm backs the pow intrinsic
+        llvm::StringRef args[] = {*driver, objectPath, "-o", outputPath, "-lm"};
+        string error;
+
+        int status = llvm::sys::ExecuteAndWait(*driver, args, llvm::None, {}, 0, 0, &error);
+        if (status != 0) {
+            throw runtime_error("Linking " + outputPath + " failed" + (error.empty() ? "" : ": " + error));
+        }
+    }
+
+}
@@ -0,0 +1,59 @@
+/***
+ * @file target.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "optimizer.hpp"
+#include <memory>
+#include <string>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Target/TargetMachine.h>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    enum class EmitKind {
+        IR,         // Textual LLVM IR
+        Assembly,   // Host assembly
+        Object,     // Host object file
+        Executable, // Object file linked by the system compiler driver
+    };
+
+    // Parses "ir", "asm", "obj" and "exe", false for anything else
+    bool parseEmitKind(const string& name, EmitKind& kind);
+
+    // Extension given to the output when no path is chosen, with its dot
+    const char* emitExtension(EmitKind kind);
+
+    struct MachineOptions {
+        // CPU to tune and select instructions for, "native" for the one running the compiler
+        string cpu = "generic";
+        // Comma separated "+feature,-feature" list on top of the CPU's, "native" for the host's
+        string features;
+    };
+
+    // Code generator effort for an optimization level
+    llvm::CodeGenOpt::Level codeGenLevel(OptLevel level);
+
+    // Machine for the host triple. Throws when LLVM was built without it
+    unique_ptr<llvm::TargetMachine> createHostMachine(const MachineOptions& options, OptLevel level);
+
+    // Writes `module` as assembly or an object file. It must already carry the machine's
+    // triple and data layout, set them before optimizing so the passes see the target too
+    void emitNative(llvm::Module& module, llvm::TargetMachine& machine, EmitKind kind, const string& path);
+
+    // Links `objectPath` into an executable through the `cc` found on PATH
+    void linkExecutable(const string& objectPath, const string& outputPath);
+
+}
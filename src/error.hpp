@@ -8,7 +8,9 @@
 // Includes //
 //////////////
 
+#include "source.hpp"
 #include <cstddef>
+#include <iterator>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -25,16 +27,19 @@ namespace Solar {
     class Error {
     public:
         string content;
-        string file;
-        size_t line;
-        size_t column;
+        TokenPos pos;
 
-        Error(string content, string file = "Unknown", size_t line = 0, size_t column = 0)
-            : content(move(content)), file(move(file)), line(line), column(column) {}
+        Error(string content, TokenPos pos = TokenPos())
+            : content(move(content)), pos(pos) {}
 
-        string format() const {
+        string format(const SourceManager* sources) const {
             ostringstream oss;
-            oss << "[Error] " << file << ":" << line << ":" << column << " -> " << content;
+            if (sources) {
+                auto [line, column] = sources->getLineColumn(pos);
+                oss << "[Error] " << sources->getName(pos.file) << ":" << line << ":" << column << " -> " << content;
+            } else {
+                oss << "[Error] Unknown:0:0 -> " << content;
+            }
             return oss.str();
         }
     };
@@ -42,10 +47,13 @@ namespace Solar {
     class ErrorSesion {
     private:
         vector<Error> errors;
+        const SourceManager* sources;
 
     public:
-        void addError(string content, string file = "Unknown", size_t line = 0, size_t column = 0) {
-            errors.emplace_back(move(content), move(file), line, column);
+        ErrorSesion(const SourceManager* sources = nullptr) : sources(sources) {}
+
+        void addError(string content, TokenPos pos = TokenPos()) {
+            errors.emplace_back(move(content), pos);
         }
 
         void debug(bool end = true) {
@@ -55,7 +63,7 @@ namespace Solar {
             }
 
             for (const auto& error : this->errors) {
-                cerr << error.format() << endl;
+                cerr << error.format(this->sources) << endl;
             }
 
             if (end) {
@@ -63,6 +71,16 @@ namespace Solar {
             }
         }
 
+        // Moves `other`'s errors after ours, used to merge per-thread sessions in a fixed order
+        void merge(ErrorSesion& other) {
+            this->errors.insert(this->errors.end(), make_move_iterator(other.errors.begin()), make_move_iterator(other.errors.end()));
+            other.clear();
+        }
+
+        const vector<Error>& getErrors() const {
+            return this->errors;
+        }
+
         bool hasErrors() const {
             return !errors.empty();
         }
@@ -0,0 +1,189 @@
+/***
+ * @file bench.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "bench.hpp"
+#include "lexer.hpp"
+#include "scan.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+
+    // Every kind of token the lexer handles, numbered so names and literals don't repeat
+    static string generateProgram(size_t bytes) {
+        string source;
+        source.reserve(bytes + 256);
+
+        for (size_t n = 0; source.size() < bytes; n++) {
+            string id = to_string(n);
+            source += "// helper number " + id + "\n";
+            source += "func helper_" + id + "(left: int, right: double): int {\n";
+            source += "   var label_" + id + ": string = \"generated literal " + id + "\";\n";
+            source += "   var scaled: double = right * " + id + ".25d;\n";
+            source += "   return left + " + id + " % 7 >= 3 && !false;\n";
+            source += "}\n\n";
+        }
+
+        return source;
+    }
+
+    // Milliseconds of the fastest of `runs` full passes over `file`, counting the tokens
+    static double timeLexing(const SourceManager& sources, FileId file, size_t runs, size_t& tokens) {
+        double best = 0;
+
+        for (size_t run = 0; run < runs; run++) {
+            ErrorSesion errSession(&sources);
+            auto start = chrono::steady_clock::now();
+
+            SymbolCache symbolCache;
+            Lexer lexer(sources, file, errSession, 0, UINT32_MAX, &symbolCache);
+            tokens = 0;
+            while (lexer.next().type != TokenType::EOF_) tokens++;
+
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            best = run == 0 ? ms : min(best, ms);
+        }
+
+        return best;
+    }
+
+    // The tables tokenize used to probe for every word, kept as the baseline to beat
+    static const unordered_map<string, TokenType> HashedKeywords = {
+        {"var", TokenType::Var}, {"class", TokenType::Class}, {"struct", TokenType::Struct}, {"new", TokenType::New},
+        {"func", TokenType::Func}, {"if", TokenType::If}, {"else", TokenType::Else}, {"foreach", TokenType::Foreach},
+        {"while", TokenType::While}, {"for", TokenType::For}, {"export", TokenType::Export}, {"typeof", TokenType::Typeof},
+        {"type", TokenType::Type}, {"in", TokenType::In}, {"return", TokenType::Return}
+    };
+
+    static const unordered_map<string, TokenType> HashedLiterals = {
+        {"true", TokenType::Bool}, {"false", TokenType::Bool}, {"null", TokenType::Null}
+    };
+
+    static TokenType hashedKeywordType(string_view view) {
+        string word(view);
+        TokenType type = TokenType::Identfier;
+
+        auto it = HashedKeywords.find(word);
+        if (it != HashedKeywords.end()) type = it->second;
+
+        auto itLiteral = HashedLiterals.find(word);
+        if (itLiteral != HashedLiterals.end()) type = itLiteral->second;
+
+        return type;
+    }
+
+    // One word in five is a keyword or literal, the rest identifiers of 2 to 24 characters
+    static string generateWords(size_t count) {
+        static const char* const keywords[] = {
+            "var", "class", "struct", "new", "func", "if", "else", "foreach", "while", "for", "export",
+            "typeof", "type", "in", "return", "true", "false", "null"
+        };
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+
+        mt19937 random(20261017);
+        string source;
+
+        for (size_t n = 0; n < count; n++) {
+            if (random() % 5 == 0) {
+                source += keywords[random() % size(keywords)];
+            } else {
+                size_t length = 2 + random() % 23;
+                source += alphabet[random() % 53]; // No leading digit
+                for (size_t c = 1; c < length; c++) source += alphabet[random() % 63];
+            }
+            source += n % 12 == 11 ? '\n' : ' ';
+        }
+
+        return source;
+    }
+
+    // Milliseconds of the fastest of `runs` passes classifying every word, `sum` folds the
+    // results so the work can't be dropped and both classifiers can be checked to agree
+    template<typename Classify>
+    static double timeClassify(const vector<string_view>& words, size_t runs, size_t& sum, Classify classify) {
+        double best = 0;
+
+        for (size_t run = 0; run < runs; run++) {
+            auto start = chrono::steady_clock::now();
+
+            sum = 0;
+            for (string_view word : words) sum = sum * 31 + static_cast<size_t>(classify(word));
+
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            best = run == 0 ? ms : min(best, ms);
+        }
+
+        return best;
+    }
+
+    // Benchmark //
+    void benchmarkLexer(ostream& out, size_t maxMegabytes) {
+        SourceManager sources;
+        char line[160];
+
+        out << "[lexer] scan kernel: " << scanKernelName() << endl;
+
+        for (size_t megabytes = 1; megabytes <= max<size_t>(maxMegabytes, 1); megabytes *= 2) {
+            FileId file = sources.addBuffer("bench-" + to_string(megabytes) + "mb.sun", generateProgram(megabytes << 20));
+            size_t bytes = sources.getBuffer(file).size();
+
+            size_t tokens = 0;
+            double ms = timeLexing(sources, file, 3, tokens);
+
+            snprintf(line, sizeof(line), "[lexer] %3zu MB  %9zu tokens  %9.2f ms  %7.1f MB/s  %6.2f ns/byte",
+                megabytes, tokens, ms, (bytes / 1048576.0) / (ms / 1000.0), ms * 1e6 / bytes);
+            out << line << endl;
+        }
+    }
+
+    void benchmarkKeywords(ostream& out, size_t wordCount) {
+        SourceManager sources;
+        FileId file = sources.addBuffer("bench-words.sun", generateWords(wordCount));
+        string_view source = sources.getBuffer(file);
+
+        vector<string_view> words;
+        words.reserve(wordCount);
+        for (size_t begin = 0; begin < source.size();) {
+            size_t end = source.find_first_of(" \n", begin);
+            words.push_back(source.substr(begin, end - begin));
+            begin = end + 1;
+        }
+
+        size_t hashedSum = 0, switchedSum = 0, tokens = 0;
+        double hashedMs = timeClassify(words, 5, hashedSum, hashedKeywordType);
+        double switchedMs = timeClassify(words, 5, switchedSum, KeywordType);
+        double lexMs = timeLexing(sources, file, 5, tokens);
+
+        if (hashedSum != switchedSum) throw runtime_error("KeywordType disagrees with the keyword tables");
+
+        char line[160];
+        snprintf(line, sizeof(line), "[keywords] %zu words, %.1f MB", words.size(), source.size() / 1048576.0);
+        out << line << endl;
+        snprintf(line, sizeof(line), "[keywords] hashed tables  %8.2f ms  %6.2f ns/word", hashedMs, hashedMs * 1e6 / words.size());
+        out << line << endl;
+        snprintf(line, sizeof(line), "[keywords] KeywordType    %8.2f ms  %6.2f ns/word  (%.1fx)", switchedMs,
+            switchedMs * 1e6 / words.size(), hashedMs / switchedMs);
+        out << line << endl;
+        snprintf(line, sizeof(line), "[keywords] full lexing    %8.2f ms  %6.2f ns/word", lexMs, lexMs * 1e6 / tokens);
+        out << line << endl;
+    }
+
+}
@@ -0,0 +1,31 @@
+/***
+ * @file bench.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <cstddef>
+#include <ostream>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Lexes generated programs of 1, 2, 4 ... `maxMegabytes` MB and reports the throughput of
+    // each size, the time per byte has to stay flat for the lexer to be linear. The scan kernel
+    // picked for this CPU is printed first
+    void benchmarkLexer(ostream& out, size_t maxMegabytes = 8);
+
+    // Classifies identifier-heavy input with KeywordType and with the hashed tables it replaced,
+    // then lexes the same input whole
+    void benchmarkKeywords(ostream& out, size_t wordCount = 3000000);
+
+}
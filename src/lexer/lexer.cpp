@@ -7,6 +7,7 @@
 //////////////
 
 #include "lexer.hpp"
+#include "scan.hpp"
 
 using namespace std;
 
@@ -16,155 +17,132 @@ using namespace std;
 
 namespace Solar {
 
-    vector<Token> tokenize(string source, string file) {
-        ErrorSesion errSession;
-        vector<Token> tokens;
-        size_t pos = 0;
-        size_t line = 1;
+    // Lexer //
+    Lexer::Lexer(const SourceManager& sources, FileId file, ErrorSesion& errSession, uint32_t begin, uint32_t end, SymbolCache* symbolCache)
+        : file(file), source(sources.getBuffer(file).substr(0, end)), i(begin), errSession(errSession), symbolCache(symbolCache) {}
+
+    TokenPos Lexer::posAt(size_t idx) const {
+        return TokenPos {this->file, static_cast<uint32_t>(idx)};
+    }
+
+    unsigned char Lexer::at(size_t idx) const {
+        return idx < this->source.size() ? static_cast<unsigned char>(this->source[idx]) : '\0';
+    }
+
+    Token Lexer::next() {
+        const string_view source = this->source;
+        const size_t size = source.size();
+        size_t& i = this->i;
 
-        while (source.size() > 0) {
-            pos += 1;
+        while (i < size) {
+            const unsigned char c = source[i];
 
             // White Space
-            if (isspace(source[0])) {
-                if (source[0] == '\n') { pos = 0; line += 1; }
-                source.erase(0, 1);
+            if (isspace(c)) {
+                i = scanWhitespace(source, i + 1);
                 continue;
             }
 
             // Comments
-            if (source[0] == '/' && source.size() > 1 && source[1] == '/') {
-                while (source.size() > 0 && source[0] != '\n') {
-                    source.erase(0, 1);
-                }
+            if (c == '/' && at(i + 1) == '/') {
+                i = findNewline(source, i + 2);
                 continue;
             }
 
             // Numbers
-            if (isdigit(source[0])) {
-                size_t start = 0;
+            if (isdigit(c)) {
+                size_t end = i;
                 bool hasDecimal = false;
 
-                while (start < source.size() && (isdigit(source[start]) || source[start] == '.')) {
-                    if (source[start] == '.') {
+                while (end < size && (isdigit(at(end)) || source[end] == '.')) {
+                    if (source[end] == '.') {
                         if (hasDecimal) {
-                            errSession.addError(
+                            this->errSession.addError(
                                 "Extra dot is not allowed",
-                                file,
-                                line,
-                                pos + start
+                                posAt(end)
                             );
                             break;
                         }
                         hasDecimal = true;
                     }
-                    start++;
+                    end++;
                 }
 
                 TokenType type_ = TokenType::Int;
 
                 if (hasDecimal) {
-                    if (start < source.size() && (source[start] == 'd' || source[start] == 'f')) {
-                        type_ = (source[start] == 'd') ? TokenType::Double : TokenType::Float;
-                        start++;
+                    if (at(end) == 'd' || at(end) == 'f') {
+                        type_ = (source[end] == 'd') ? TokenType::Double : TokenType::Float;
+                        end++;
                     } else {
-                        errSession.addError(
+                        this->errSession.addError(
                             "Decimal number needs a type specification after declaration ( f = float, d = double )",
-                            file,
-                            line,
-                            pos + start
+                            posAt(end)
                         );
                     }
                 }
 
-                tokens.push_back(Token {{line, pos, file}, type_, source.substr(0, start)});
-                source.erase(0, start);
-                pos += start;
-                continue;
+                Token token {posAt(i), type_, InvalidSymbol, source.substr(i, end - i)};
+                i = end;
+                return token;
             }
 
             // Chars
-            if (source[0] == '\'') {
-                if (source.size() < 3 || source[2] != '\'') {
-                    errSession.addError(
+            if (c == '\'') {
+                if (size - i < 3 || source[i + 2] != '\'') {
+                    this->errSession.addError(
                         "Expected closing ' at: ",
-                        file,
-                        line,
-                        pos
+                        posAt(i)
                     );
-                    source.erase(0, 1);
-                    pos += 1;
+                    i += 1;
                     continue;
                 }
 
-                string chr(1, source[1]);
-                tokens.push_back(Token {{line, pos, file}, TokenType::Char, chr});
-                source.erase(0, 3);
-                pos += 3;
-                continue;
+                Token token {posAt(i), TokenType::Char, InvalidSymbol, source.substr(i + 1, 1)};
+                i += 3;
+                return token;
             }
 
             // Strings
-            if (source[0] == '"') {
-                size_t endPos = 1;
-                string str;
-
-                while (endPos < source.size()) {
-                    if (source[endPos] == '"' && source[endPos - 1] != '\\') {
-                        break;
-                    }
+            if (c == '"') {
+                size_t end = findQuote(source, i + 1);
 
-                    str += source[endPos];
-                    endPos++;
+                while (end < size && source[end - 1] == '\\') {
+                    end = findQuote(source, end + 1);
                 }
 
-                if (endPos >= source.size()) {
-                    errSession.addError(
+                if (end >= size) {
+                    this->errSession.addError(
                         "Unterminated string",
-                        file,
-                        line,
-                        pos
+                        posAt(i)
                     );
-                    source.erase(0, 1);
-                    pos += 1;
+                    i += 1;
                     continue;
                 }
 
-                tokens.push_back(Token {{line, pos, file}, TokenType::String, str});
-                source.erase(0, endPos + 1);
-                pos += endPos + 1;
-                continue;
+                Token token {posAt(i), TokenType::String, InvalidSymbol, source.substr(i + 1, end - i - 1)};
+                i = end + 1;
+                return token;
             }
 
             // Identifiers Keywords TypesLiterals
-            if (isalpha(source[0]) || source[0] == '_') {
-                size_t start = 0;
-                while (start < source.size() && (isalnum(source[start]) || source[start] == '_')) {
-                    start++;
-                }
+            if (isalpha(c) || c == '_') {
+                size_t end = scanIdentifier(source, i + 1);
 
-                string word = source.substr(0, start);
-                TokenType type = TokenType::Identfier;
+                string_view word = source.substr(i, end - i);
+                TokenType type = KeywordType(word);
 
-                auto it = Keywords.find(word);
-                if (it != Keywords.end()) {
-                    type = it->second;
-                }
-
-                auto itType = TypesLiteral.find(word);
-                if (itType != TypesLiteral.end()) {
-                    type = itType->second;
-                }
+                Symbol symbol = InvalidSymbol;
+                if (type == TokenType::Identfier) symbol = symbolCache ? symbolCache->intern(word) : symbols().intern(word);
 
-                tokens.push_back(Token {{line, pos, file}, type, word});
-                source.erase(0, start);
-                pos += start - 1;
-                continue;
+                Token token {posAt(i), type, symbol, word};
+                i = end;
+                return token;
             }
 
             // Double Operators
-            if (source.size() > 1) {
-                string op = source.substr(0, 2);
+            if (size - i > 1) {
+                string_view op = source.substr(i, 2);
                 bool found = true;
 
                 TokenType type;
@@ -186,16 +164,15 @@ namespace Solar {
                 else found = false;
 
                 if (found) {
-                    tokens.push_back(Token {{line, pos, file}, type, op});
-                    source.erase(0, 2);
-                    pos++;
-                    continue;
+                    Token token {posAt(i), type, InvalidSymbol, op};
+                    i += 2;
+                    return token;
                 }
             }
 
             // Single Characters
             TokenType type;
-            switch (source[0]) {
+            switch (c) {
                 case '(': type = TokenType::OpenParen; break;
                 case ')': type = TokenType::CloseParen; break;
                 case '[': type = TokenType::OpenBracket; break;
@@ -221,28 +198,80 @@ namespace Solar {
                 case '%': type = TokenType::Mod; break;
                 case '!': type = TokenType::Not; break;
                 default: {
-                    errSession.addError(
+                    this->errSession.addError(
                         "Unexpected character: '" + 
-                        string(1, source[0]) + "'",
-                        file,
-                        line,
-                        pos
+                        string(1, source[i]) + "'",
+                        posAt(i)
                     );
-                    source.erase(0, 1);
-                    pos += 1;
+                    i += 1;
                     continue;
                 }
             }
 
-            tokens.push_back(Token {{line, pos, file}, type, string(1, source[0])});
-            source.erase(0, 1);
+            Token token {posAt(i), type, InvalidSymbol, source.substr(i, 1)};
+            i += 1;
+            return token;
         }
 
-        errSession.debug();
+        return Token {posAt(size), TokenType::EOF_, InvalidSymbol, string_view()};
+    }
+
+    // Token Stream //
+    TokenStream::TokenStream(const SourceManager& sources, FileId file, ErrorSesion& errSession, uint32_t begin, uint32_t end,
+        SymbolCache* symbolCache)
+        : lexer(in_place, sources, file, errSession, begin, end, symbolCache), head(0), count(0) {}
 
-        tokens.push_back(Token {{line, pos, file}, TokenType::EOF_, ""});
+    TokenStream::TokenStream(const Token* first, const Token* last, const Token& eof)
+        : head(0), count(0), spanNext(first), spanEnd(last), spanEof(eof) {}
+
+    const Token& TokenStream::peek(size_t ahead) {
+        // Filling past the window would overwrite tokens that were not consumed yet
+        if (ahead >= Lookahead) {
+            throw runtime_error("TokenStream::peek(" + to_string(ahead) + ") is past the lookahead of " + to_string(Lookahead));
+        }
+
+        // Spans are read in place, nothing to fill
+        if (!this->lexer) {
+            return ahead < static_cast<size_t>(this->spanEnd - this->spanNext) ? this->spanNext[ahead] : this->spanEof;
+        }
+
+        while (this->count <= ahead) {
+            this->ring[(this->head + this->count) % Lookahead] = this->lexer->next();
+            this->count++;
+        }
+
+        return this->ring[(this->head + ahead) % Lookahead];
+    }
+
+    Token TokenStream::next() {
+        Token tk = this->peek();
+
+        if (!this->lexer) {
+            if (this->spanNext != this->spanEnd) this->spanNext++;
+            return tk;
+        }
+
+        if (tk.type != TokenType::EOF_) {
+            this->head = (this->head + 1) % Lookahead;
+            this->count--;
+        }
+
+        return tk;
+    }
+
+    // Helpers //
+    vector<Token> tokenize(const SourceManager& sources, FileId file) {
+        ErrorSesion errSession(&sources);
+        SymbolCache symbolCache;
+        Lexer lexer(sources, file, errSession, 0, UINT32_MAX, &symbolCache);
+        vector<Token> tokens;
+
+        do {
+            tokens.push_back(lexer.next());
+        } while (tokens.back().type != TokenType::EOF_);
+
+        errSession.debug();
         return tokens;
     }
 
 }
-
@@ -10,8 +10,12 @@
 
 #include "pack.hpp"
 #include "error.hpp"
+#include <array>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 
 using namespace std;
@@ -22,6 +26,56 @@ using namespace std;
 
 namespace Solar {
 
-    std::vector<Token> tokenize(string source, string file = "Unknow");
+    // Pulls one token at a time; tokens reference spans of the file's buffer owned by `sources`
+    class Lexer {
+    private:
+        FileId file;
+        string_view source;
+        size_t i;
+        ErrorSesion& errSession;
+        SymbolCache* symbolCache;
+
+        TokenPos posAt(size_t idx) const;
+        unsigned char at(size_t idx) const;
+
+    public:
+        // Lexes bytes [begin, end) of the file, positions stay relative to the whole file.
+        // Identifiers go through `symbolCache` when given, straight to symbols() otherwise
+        Lexer(const SourceManager& sources, FileId file, ErrorSesion& errSession, uint32_t begin = 0, uint32_t end = UINT32_MAX,
+            SymbolCache* symbolCache = nullptr);
+
+        // Keeps returning EOF_ once the buffer is exhausted
+        Token next();
+    };
+
+    // Lazy token source with a bounded lookahead window, over a Lexer or over a span of
+    // tokens lexed already
+    class TokenStream {
+    public:
+        static constexpr size_t Lookahead = 4;
+
+    private:
+        optional<Lexer> lexer; // Empty when reading a span
+        array<Token, Lookahead> ring;
+        size_t head;
+        size_t count;
+
+        const Token* spanNext = nullptr;
+        const Token* spanEnd = nullptr;
+        Token spanEof;
+
+    public:
+        TokenStream(const SourceManager& sources, FileId file, ErrorSesion& errSession, uint32_t begin = 0, uint32_t end = UINT32_MAX,
+            SymbolCache* symbolCache = nullptr);
+        // Reads [first, last) then keeps returning `eof`, the tokens must outlive the stream
+        TokenStream(const Token* first, const Token* last, const Token& eof);
+
+        // Throws unless `ahead` is lower than Lookahead, the reference lives until the next call to next()
+        const Token& peek(size_t ahead = 0);
+        Token next();
+    };
+
+    // Lexes the whole file at once
+    std::vector<Token> tokenize(const SourceManager& sources, FileId file);
 
 }
\ No newline at end of file
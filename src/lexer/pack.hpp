@@ -1,4 +1,5 @@
 #pragma once
 
 #include "tokens.hpp"
-#include "lexer.hpp"
\ No newline at end of file
+#include "lexer.hpp"
+#include "bench.hpp"
\ No newline at end of file
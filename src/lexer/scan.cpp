@@ -0,0 +1,201 @@
+/***
+ * @file scan.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "scan.hpp"
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(SOLAR_NO_SIMD)
+    #define SOLAR_SCAN_X86
+    #include <immintrin.h>
+#endif
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Scalar //
+    static inline bool isSpaceByte(unsigned char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    static inline bool isIdentByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    static size_t whitespaceScalar(const char* data, size_t i, size_t size) {
+        while (i < size && isSpaceByte(static_cast<unsigned char>(data[i]))) i++;
+        return i;
+    }
+
+    static size_t identifierScalar(const char* data, size_t i, size_t size) {
+        while (i < size && isIdentByte(static_cast<unsigned char>(data[i]))) i++;
+        return i;
+    }
+
+    template <char Target>
+    static size_t findScalar(const char* data, size_t i, size_t size) {
+        while (i < size && data[i] != Target) i++;
+        return i;
+    }
+
+#ifdef SOLAR_SCAN_X86
+
+    // Unsigned `x <= limit` per byte
+    static inline __m128i lessEq128(__m128i x, __m128i limit) {
+        return _mm_cmpeq_epi8(_mm_min_epu8(x, limit), x);
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i lessEq256(__m256i x, __m256i limit) {
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(x, limit), x);
+    }
+
+    static inline __m128i spaceMask128(__m128i x) {
+        __m128i ctrl = lessEq128(_mm_sub_epi8(x, _mm_set1_epi8('\t')), _mm_set1_epi8('\r' - '\t'));
+        return _mm_or_si128(ctrl, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i spaceMask256(__m256i x) {
+        __m256i ctrl = lessEq256(_mm256_sub_epi8(x, _mm256_set1_epi8('\t')), _mm256_set1_epi8('\r' - '\t'));
+        return _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+    }
+
+    static inline __m128i identMask128(__m128i x) {
+        __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        __m128i alpha = lessEq128(_mm_sub_epi8(lower, _mm_set1_epi8('a')), _mm_set1_epi8('z' - 'a'));
+        __m128i digit = lessEq128(_mm_sub_epi8(x, _mm_set1_epi8('0')), _mm_set1_epi8('9' - '0'));
+        __m128i under = _mm_cmpeq_epi8(x, _mm_set1_epi8('_'));
+        return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i identMask256(__m256i x) {
+        __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i alpha = lessEq256(_mm256_sub_epi8(lower, _mm256_set1_epi8('a')), _mm256_set1_epi8('z' - 'a'));
+        __m256i digit = lessEq256(_mm256_sub_epi8(x, _mm256_set1_epi8('0')), _mm256_set1_epi8('9' - '0'));
+        __m256i under = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_'));
+        return _mm256_or_si256(_mm256_or_si256(alpha, digit), under);
+    }
+
+    // SSE2 (baseline on x86-64) //
+    static size_t whitespaceSSE2(const char* data, size_t i, size_t size) {
+        for (; i + 16 <= size; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            uint32_t stop = ~static_cast<uint32_t>(_mm_movemask_epi8(spaceMask128(chunk))) & 0xFFFF;
+            if (stop) return i + __builtin_ctz(stop);
+        }
+        return whitespaceScalar(data, i, size);
+    }
+
+    static size_t identifierSSE2(const char* data, size_t i, size_t size) {
+        for (; i + 16 <= size; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            uint32_t stop = ~static_cast<uint32_t>(_mm_movemask_epi8(identMask128(chunk))) & 0xFFFF;
+            if (stop) return i + __builtin_ctz(stop);
+        }
+        return identifierScalar(data, i, size);
+    }
+
+    template <char Target>
+    static size_t findSSE2(const char* data, size_t i, size_t size) {
+        const __m128i target = _mm_set1_epi8(Target);
+        for (; i + 16 <= size; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            uint32_t hit = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, target)));
+            if (hit) return i + __builtin_ctz(hit);
+        }
+        return findScalar<Target>(data, i, size);
+    }
+
+    // AVX2 //
+    __attribute__((target("avx2")))
+    static size_t whitespaceAVX2(const char* data, size_t i, size_t size) {
+        for (; i + 32 <= size; i += 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            uint32_t stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(spaceMask256(chunk)));
+            if (stop) return i + __builtin_ctz(stop);
+        }
+        return whitespaceSSE2(data, i, size);
+    }
+
+    __attribute__((target("avx2")))
+    static size_t identifierAVX2(const char* data, size_t i, size_t size) {
+        for (; i + 32 <= size; i += 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            uint32_t stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(identMask256(chunk)));
+            if (stop) return i + __builtin_ctz(stop);
+        }
+        return identifierSSE2(data, i, size);
+    }
+
+    template <char Target>
+    __attribute__((target("avx2")))
+    static size_t findAVX2(const char* data, size_t i, size_t size) {
+        const __m256i target = _mm256_set1_epi8(Target);
+        for (; i + 32 <= size; i += 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            uint32_t hit = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, target)));
+            if (hit) return i + __builtin_ctz(hit);
+        }
+        return findSSE2<Target>(data, i, size);
+    }
+
+#endif
+
+    // Dispatch //
+    using ScanFn = size_t (*)(const char*, size_t, size_t);
+
+    struct ScanKernels {
+        const char* name;
+        ScanFn whitespace;
+        ScanFn identifier;
+        ScanFn newline;
+        ScanFn quote;
+    };
+
+    static const ScanKernels& kernels() {
+        static const ScanKernels selected = []() -> ScanKernels {
+#ifdef SOLAR_SCAN_X86
+            if (__builtin_cpu_supports("avx2")) {
+                return {"avx2", whitespaceAVX2, identifierAVX2, findAVX2<'\n'>, findAVX2<'"'>};
+            }
+            return {"sse2", whitespaceSSE2, identifierSSE2, findSSE2<'\n'>, findSSE2<'"'>};
+#else
+            return {"scalar", whitespaceScalar, identifierScalar, findScalar<'\n'>, findScalar<'"'>};
+#endif
+        }();
+
+        return selected;
+    }
+
+    size_t scanWhitespace(string_view source, size_t from) {
+        return kernels().whitespace(source.data(), from, source.size());
+    }
+
+    size_t scanIdentifier(string_view source, size_t from) {
+        return kernels().identifier(source.data(), from, source.size());
+    }
+
+    size_t findNewline(string_view source, size_t from) {
+        return kernels().newline(source.data(), from, source.size());
+    }
+
+    size_t findQuote(string_view source, size_t from) {
+        return kernels().quote(source.data(), from, source.size());
+    }
+
+    const char* scanKernelName() {
+        return kernels().name;
+    }
+
+}
@@ -0,0 +1,42 @@
+/***
+ * @file scan.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <cstddef>
+#include <string_view>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Byte-run scanners used by the lexer. Each one returns the index of the first
+    // byte at or after `from` that ends the run, or source.size() if none does.
+    // SSE2/AVX2 kernels are picked once at runtime, with a scalar fallback
+    // (forced by defining SOLAR_NO_SIMD).
+
+    // Skips ' ', '\t', '\n', '\v', '\f' and '\r'
+    size_t scanWhitespace(string_view source, size_t from);
+
+    // Stops at [A-Za-z0-9_] boundary
+    size_t scanIdentifier(string_view source, size_t from);
+
+    // Stops at '\n', used to skip comments
+    size_t findNewline(string_view source, size_t from);
+
+    // Stops at '"'
+    size_t findQuote(string_view source, size_t from);
+
+    // "avx2", "sse2" or "scalar"
+    const char* scanKernelName();
+
+}
@@ -8,10 +8,13 @@
 // Includes //
 //////////////
 
+#include "source.hpp"
+#include "symbols.hpp"
 #include <cstddef>
 #include <iostream>
 #include <vector>
-#include <unordered_map>
+#include <string>
+#include <string_view>
 
 using namespace std;
 
@@ -94,46 +97,67 @@ namespace Solar {
         Return,
     };
 
-    struct TokenPos {
-        size_t line;
-        size_t collum;
-        string file;
-
-        string toString() const {
-            return file + "-" + to_string(this->line) + ":" + to_string(this->collum);
-        };
-    };
+    // Keep in sync with the last TokenType, used to size per-type tables
+    constexpr size_t TokenTypeCount = static_cast<size_t>(TokenType::Return) + 1;
 
     struct Token {
         TokenPos pos;
         TokenType type;
-        string content;
+        Symbol symbol;       // Interned name for identifiers, InvalidSymbol otherwise
+        string_view content; // Span of the source buffer
     };
 
     // Constants
-    const unordered_map<string, TokenType> Keywords = {
-        {"var", TokenType::Var},
-        {"class", TokenType::Class},
-        {"struct", TokenType::Struct},
-        {"new", TokenType::New},
-        {"func", TokenType::Func},
-        {"if", TokenType::If},
-        {"else", TokenType::Else},
-        {"foreach", TokenType::Foreach},
-        {"while", TokenType::While},
-        {"for", TokenType::For},
-        {"export", TokenType::Export},
-        {"typeof", TokenType::Typeof},
-        {"type", TokenType::Type},
-        {"in", TokenType::In},
-        {"return", TokenType::Return}
-    };
+    // Keywords and literal words ( true, false, null ), switched on length and first
+    // letter so recognizing a word never allocates nor hashes the identifier
+    constexpr TokenType KeywordType(string_view word) {
+        switch (word.size()) {
+            case 2:
+                switch (word[0]) {
+                    case 'i': return word == "if" ? TokenType::If : word == "in" ? TokenType::In : TokenType::Identfier;
+                }
+                break;
+            case 3:
+                switch (word[0]) {
+                    case 'v': if (word == "var") return TokenType::Var; break;
+                    case 'n': if (word == "new") return TokenType::New; break;
+                    case 'f': if (word == "for") return TokenType::For; break;
+                }
+                break;
+            case 4:
+                switch (word[0]) {
+                    case 'f': if (word == "func") return TokenType::Func; break;
+                    case 'e': if (word == "else") return TokenType::Else; break;
+                    case 't': return word == "type" ? TokenType::Type : word == "true" ? TokenType::Bool : TokenType::Identfier;
+                    case 'n': if (word == "null") return TokenType::Null; break;
+                }
+                break;
+            case 5:
+                switch (word[0]) {
+                    case 'c': if (word == "class") return TokenType::Class; break;
+                    case 'w': if (word == "while") return TokenType::While; break;
+                    case 'f': if (word == "false") return TokenType::Bool; break;
+                }
+                break;
+            case 6:
+                switch (word[0]) {
+                    case 's': if (word == "struct") return TokenType::Struct; break;
+                    case 'e': if (word == "export") return TokenType::Export; break;
+                    case 't': if (word == "typeof") return TokenType::Typeof; break;
+                    case 'r': if (word == "return") return TokenType::Return; break;
+                }
+                break;
+            case 7:
+                if (word == "foreach") return TokenType::Foreach;
+                break;
+        }
 
-    const unordered_map<string, TokenType> TypesLiteral = {
-        {"true", TokenType::Bool},
-        {"false", TokenType::Bool},
-        {"null", TokenType::Null}
-    };
+        return TokenType::Identfier;
+    }
+
+    static_assert(KeywordType("foreach") == TokenType::Foreach, "KeywordType table is broken");
+    static_assert(KeywordType("false") == TokenType::Bool, "KeywordType table is broken");
+    static_assert(KeywordType("types") == TokenType::Identfier, "KeywordType table is broken");
 
     // Functions
     inline string TToString(const TokenType& tt) {
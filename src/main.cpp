@@ -7,11 +7,10 @@
 //////////////
 
 #include "solar_pack.hpp"
+#include <chrono>
 #include <stdexcept>
 #include <string>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 
 using namespace std;
 
@@ -19,22 +18,144 @@ using namespace std;
 // Code //
 //////////
 
-string readFile(const string& path) {
-    ifstream file(path);
-    if (!file.is_open()) {
-        throw runtime_error("Cant open the file: " + path);
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Runs main through the bytecode VM and the JIT, each from a fresh front end, and prints the
+// times side by side. Returns the exit code both agreed on
+static int benchmark(const string& path, const CompileOptions& options) {
+    auto vmStart = chrono::steady_clock::now();
+    SourceManager vmSources;
+    Program program = compileBytecode(vmSources, vmSources.loadFile(path), options.cacheDir);
+    double vmLowerMs = elapsedMs(vmStart);
+
+    auto vmRunStart = chrono::steady_clock::now();
+    int vmExit = VM().runMain(program);
+    double vmRunMs = elapsedMs(vmRunStart);
+
+    CompileOptions jitOptions = options;
+    jitOptions.dumps = false;
+    jitOptions.emit = EmitKind::IR;
+
+    auto frontStart = chrono::steady_clock::now();
+    SourceManager jitSources;
+    Compiler compiler(jitOptions);
+    compiler.buildModule(jitSources, jitSources.loadFile(path));
+    double frontMs = elapsedMs(frontStart);
+
+    auto [context, module] = compiler.releaseModule();
+    RunResult jit = runMain(move(context), move(module), jitOptions.pipeline.level, jitOptions.cacheDir);
+
+    cerr << "[bench] vm:  front end + lowering " << vmLowerMs << " ms, execution " << vmRunMs << " ms, total "
+        << vmLowerMs + vmRunMs << " ms" << endl;
+    cerr << "[bench] jit: front end " << frontMs << " ms, JIT compile " << jit.compileMs << " ms" << (jit.cached ? " (cached)" : "")
+        << ", execution " << jit.runMs << " ms, total " << frontMs + jit.compileMs + jit.runMs << " ms" << endl;
+
+    if (vmExit != jit.exitCode) {
+        throw runtime_error("VM and JIT disagree: " + to_string(vmExit) + " vs " + to_string(jit.exitCode));
     }
 
-    stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    return vmExit;
 }
 
-int main()
+int main(int argc, char** argv)
 {
-    Compiler compiler;
+    SourceManager sources;
+    CompileOptions options;
+    string path = "../test/script.sun";
+
+    // `solar run file.sun` executes main in-process through the JIT instead of writing anything,
+    // `solar vm file.sun` through the bytecode VM, `solar bench file.sun` through both
+    const string command = argc > 1 ? argv[1] : "";
+    bool run = command == "run";
+    bool vm = command == "vm";
+    bool bench = command == "bench";
+    bool disassemble = false;
+
+    // `solar bench-lexer [max MB]` times the lexer alone on generated sources, then keyword
+    // recognition on identifier-heavy input
+    if (command == "bench-lexer") {
+        benchmarkLexer(cout, argc > 2 ? stoul(argv[2]) : 8);
+        benchmarkKeywords(cout);
+        return 0;
+    }
+
+    // `solar bench-edit [functions]` edits a generated file incrementally, fails on a keystroke
+    // over 10 ms or on a tree that differs from a full rebuild
+    if (command == "bench-edit") {
+        return benchmarkEdits(cout, argc > 2 ? stoul(argv[2]) : 4000) ? 0 : 1;
+    }
+
+    // `solar bench-parse [functions]` parses a generated file sequentially and with 1 to 8
+    // threads, fails when a parallel tree differs
+    if (command == "bench-parse") {
+        return benchmarkParse(cout, argc > 2 ? stoul(argv[2]) : 20000) ? 0 : 1;
+    }
+
+    // "-" reads the source from stdin
+    for (int i = run || vm || bench ? 2 : 1; i < argc; i++) {
+        const string arg = argv[i];
+        if (parseOptLevel(arg, options.pipeline.level)) continue;
+
+        if (arg == "--lazy") {
+            options.lazyBodies = true;
+        } else if (arg == "--cache" && i + 1 < argc) {
+            options.cacheDir = argv[++i];
+        } else if (arg == "--time-passes") {
+            options.pipeline.timePasses = true;
+        } else if (arg == "--print-after-all") {
+            options.pipeline.printAfterAll = true;
+        } else if (arg == "--emit" && i + 1 < argc) {
+            if (!parseEmitKind(argv[++i], options.emit)) throw runtime_error("Unknown --emit kind: " + string(argv[i]));
+        } else if (arg == "-o" && i + 1 < argc) {
+            options.outputPath = argv[++i];
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            options.machine.cpu = argv[++i];
+        } else if (arg == "--features" && i + 1 < argc) {
+            options.machine.features = argv[++i];
+        } else if (arg == "--disasm") {
+            disassemble = true;
+        } else {
+            path = arg;
+        }
+    }
+
+    if (bench) return benchmark(path, options);
+
+    if (vm) {
+        auto lowerStart = chrono::steady_clock::now();
+        Program program = compileBytecode(sources, sources.loadFile(path), options.cacheDir);
+        double lowerMs = elapsedMs(lowerStart);
+
+        if (disassemble) cout << program.disassemble();
+
+        auto runStart = chrono::steady_clock::now();
+        int exitCode = VM().runMain(program);
+
+        cerr << "[vm] front end + lowering " << lowerMs << " ms, execution " << elapsedMs(runStart) << " ms" << endl;
+        return exitCode;
+    }
+
+    if (run) {
+        options.dumps = false;
+        options.emit = EmitKind::IR;
+
+        auto frontStart = chrono::steady_clock::now();
+        Compiler compiler(options);
+        compiler.buildModule(sources, sources.loadFile(path));
+        double frontMs = elapsedMs(frontStart);
+
+        auto [context, module] = compiler.releaseModule();
+        RunResult result = runMain(move(context), move(module), options.pipeline.level, options.cacheDir);
+
+        cerr << "[run] front end " << frontMs << " ms, JIT compile " << result.compileMs << " ms" << (result.cached ? " (cached)" : "")
+            << ", execution " << result.runMs << " ms" << endl;
+        return result.exitCode;
+    }
 
-    compiler.compileCode(readFile("../test/script.sun"));
+    Compiler compiler(options);
+    compiler.compileCode(sources, sources.loadFile(path));
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+/***
+ * @file parallel.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Forces workerCount when non-zero, lets benchmarks compare thread counts in one process
+    inline atomic<size_t>& workerOverride() {
+        static atomic<size_t> count {0};
+        return count;
+    }
+
+    // Threads the parallel passes may use, SOLAR_THREADS overrides the hardware count
+    inline size_t workerCount() {
+        if (size_t forced = workerOverride().load()) return forced;
+
+        if (const char* env = getenv("SOLAR_THREADS")) {
+            long requested = strtol(env, nullptr, 10);
+            if (requested > 0) return static_cast<size_t>(requested);
+        }
+
+        return max<size_t>(1, thread::hardware_concurrency());
+    }
+
+    // Workers parallelFor will start for `count` tasks
+    inline size_t parallelWorkers(size_t count) {
+        return max<size_t>(1, min(workerCount(), count));
+    }
+
+    // Runs task(index, worker) for every index in [0, count). Workers pull indices from a
+    // shared counter so uneven tasks balance out; `worker` is below parallelWorkers(count)
+    // and lets callers keep per-thread state. The first exception thrown is rethrown here.
+    template <typename Task>
+    void parallelFor(size_t count, Task&& task) {
+        size_t workers = parallelWorkers(count);
+
+        if (workers == 1) {
+            for (size_t i = 0; i < count; i++) task(i, 0);
+            return;
+        }
+
+        atomic<size_t> nextIndex {0};
+        exception_ptr failure;
+        once_flag failureOnce;
+
+        auto work = [&](size_t worker) {
+            try {
+                for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+                    task(i, worker);
+                }
+            } catch (...) {
+                call_once(failureOnce, [&failure]() { failure = current_exception(); });
+                nextIndex = count;
+            }
+        };
+
+        vector<thread> threads;
+        threads.reserve(workers - 1);
+        for (size_t worker = 1; worker < workers; worker++) {
+            threads.emplace_back(work, worker);
+        }
+
+        work(0);
+        for (auto& runner : threads) runner.join();
+
+        if (failure) rethrow_exception(failure);
+    }
+
+}
@@ -3,4 +3,5 @@
 #include "error.hpp"
 #include "lexer/pack.hpp"
 #include "ast/pack.hpp"
-#include "compiler/pack.hpp"
\ No newline at end of file
+#include "compiler/pack.hpp"
+#include "vm/pack.hpp"
\ No newline at end of file
@@ -0,0 +1,124 @@
+/***
+ * @file source.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "source.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Helpers //
+    static string readStream(istream& stream) {
+        string content;
+        char chunk[1 << 16];
+
+        while (stream.read(chunk, sizeof(chunk)) || stream.gcount() > 0) {
+            content.append(chunk, static_cast<size_t>(stream.gcount()));
+        }
+
+        return content;
+    }
+
+    static void* mapFile(const string& path, size_t& size) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+        LARGE_INTEGER fileSize;
+        if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+
+        size = static_cast<size_t>(fileSize.QuadPart);
+        return data;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+            close(fd);
+            return nullptr;
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED) return nullptr;
+
+        madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        size = static_cast<size_t>(info.st_size);
+        return data;
+#endif
+    }
+
+    SourceManager::SourceFile::~SourceFile() {
+        if (!this->mapping) return;
+
+#ifdef _WIN32
+        UnmapViewOfFile(this->mapping);
+#else
+        munmap(this->mapping, this->mappingSize);
+#endif
+    }
+
+    // Loading //
+    FileId SourceManager::loadFile(const string& path) {
+        auto sourceFile = make_unique<SourceFile>();
+        sourceFile->name = path;
+
+        if (path == "-") {
+            sourceFile->name = "stdin";
+            sourceFile->owned = readStream(cin);
+            sourceFile->buffer = sourceFile->owned;
+        } else if (void* data = mapFile(path, sourceFile->mappingSize)) {
+            sourceFile->mapping = data;
+            sourceFile->buffer = string_view(static_cast<const char*>(data), sourceFile->mappingSize);
+        } else {
+            ifstream file(path, ios::binary);
+            if (!file.is_open()) {
+                throw runtime_error("Cant open the file: " + path);
+            }
+
+            sourceFile->owned = readStream(file);
+            sourceFile->buffer = sourceFile->owned;
+        }
+
+        if (sourceFile->buffer.size() > UINT32_MAX) {
+            throw runtime_error("Source file too large: " + path);
+        }
+
+        this->files.push_back(move(sourceFile));
+        return static_cast<FileId>(this->files.size() - 1);
+    }
+
+}
@@ -0,0 +1,121 @@
+/***
+ * @file source.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    using FileId = uint32_t;
+
+    const FileId InvalidFile = UINT32_MAX;
+
+    // Compact location: line and column are only resolved for diagnostics
+    struct TokenPos {
+        FileId file = InvalidFile;
+        uint32_t offset = 0;
+    };
+
+    class SourceManager {
+    private:
+        struct SourceFile {
+            string name;
+            string_view buffer;
+            string owned;            // Backing storage for in-memory and buffered sources
+            void* mapping = nullptr; // Read-only mapping of the file, if mmapped
+            size_t mappingSize = 0;
+
+            ~SourceFile();
+
+            // Filled on the first line/column query
+            once_flag linesOnce;
+            vector<uint32_t> lineStarts;
+        };
+
+        vector<unique_ptr<SourceFile>> files;
+
+        const SourceFile* getFile(FileId file) const {
+            return file < this->files.size() ? this->files[file].get() : nullptr;
+        }
+
+    public:
+        FileId addBuffer(string name, string buffer) {
+            auto sourceFile = make_unique<SourceFile>();
+            sourceFile->name = move(name);
+            sourceFile->owned = move(buffer);
+            sourceFile->buffer = sourceFile->owned;
+
+            this->files.push_back(move(sourceFile));
+            return static_cast<FileId>(this->files.size() - 1);
+        }
+
+        // Maps regular files read-only, falls back to a buffered read for pipes and "-" (stdin)
+        FileId loadFile(const string& path);
+
+        // New text for an existing file, views and positions into the old one are invalid afterwards
+        void replaceBuffer(FileId file, string buffer) {
+            auto sourceFile = make_unique<SourceFile>();
+            sourceFile->name = this->getName(file);
+            sourceFile->owned = move(buffer);
+            sourceFile->buffer = sourceFile->owned;
+
+            this->files[file] = move(sourceFile);
+        }
+
+        string_view getBuffer(FileId file) const {
+            auto sourceFile = this->getFile(file);
+            return sourceFile ? sourceFile->buffer : string_view();
+        }
+
+        string getName(FileId file) const {
+            auto sourceFile = this->getFile(file);
+            return sourceFile ? sourceFile->name : "Unknown";
+        }
+
+        // 1-based line and column of a position
+        pair<size_t, size_t> getLineColumn(TokenPos pos) const {
+            auto sourceFile = const_cast<SourceFile*>(this->getFile(pos.file));
+            if (!sourceFile) return {0, 0};
+
+            call_once(sourceFile->linesOnce, [sourceFile]() {
+                sourceFile->lineStarts.push_back(0);
+                for (size_t i = 0; i < sourceFile->buffer.size(); i++) {
+                    if (sourceFile->buffer[i] == '\n') {
+                        sourceFile->lineStarts.push_back(static_cast<uint32_t>(i + 1));
+                    }
+                }
+            });
+
+            const auto& starts = sourceFile->lineStarts;
+            auto it = upper_bound(starts.begin(), starts.end(), pos.offset);
+            size_t line = static_cast<size_t>(it - starts.begin());
+
+            return {line, pos.offset - starts[line - 1] + 1};
+        }
+
+        string toString(TokenPos pos) const {
+            auto [line, column] = this->getLineColumn(pos);
+            return this->getName(pos.file) + "-" + to_string(line) + ":" + to_string(column);
+        }
+    };
+
+}
@@ -0,0 +1,118 @@
+/***
+ * @file symbols.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Interned identifier, equal names always get the same id
+    using Symbol = uint32_t;
+
+    const Symbol InvalidSymbol = UINT32_MAX;
+
+    // Names are written once into fixed-size chunks that never move, so name() reads without
+    // locking: every slot below `count` was filled before the count covering it was published.
+    // Only intern() misses take the exclusive lock
+    class Interner {
+    private:
+        static constexpr size_t ChunkBits = 14;
+        static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+        static constexpr size_t MaxChunks = size_t(1) << (32 - ChunkBits);
+
+        mutable shared_mutex mutex;
+        unordered_map<string_view, Symbol> ids; // Views into the chunks
+        atomic<string*> chunks[MaxChunks] {};
+        atomic<Symbol> count {0};
+
+    public:
+        Interner() = default;
+        Interner(const Interner&) = delete;
+        Interner& operator=(const Interner&) = delete;
+
+        ~Interner() {
+            for (auto& chunk : this->chunks) delete[] chunk.load(memory_order_relaxed);
+        }
+
+        Symbol intern(string_view name) {
+            {
+                shared_lock<shared_mutex> lock(this->mutex);
+                auto it = this->ids.find(name);
+                if (it != this->ids.end()) return it->second;
+            }
+
+            unique_lock<shared_mutex> lock(this->mutex);
+            auto it = this->ids.find(name);
+            if (it != this->ids.end()) return it->second;
+
+            Symbol symbol = this->count.load(memory_order_relaxed);
+            auto& chunk = this->chunks[symbol >> ChunkBits];
+            if (!chunk.load(memory_order_relaxed)) chunk.store(new string[ChunkSize], memory_order_relaxed);
+
+            string& slot = chunk.load(memory_order_relaxed)[symbol & (ChunkSize - 1)];
+            slot.assign(name);
+            this->ids.emplace(slot, symbol);
+
+            this->count.store(symbol + 1, memory_order_release);
+            return symbol;
+        }
+
+        string_view name(Symbol symbol) const {
+            if (symbol >= this->count.load(memory_order_acquire)) return string_view();
+            return this->chunks[symbol >> ChunkBits].load(memory_order_relaxed)[symbol & (ChunkSize - 1)];
+        }
+
+        size_t size() const {
+            return this->count.load(memory_order_acquire);
+        }
+    };
+
+    // Shared by every stage so a Symbol means the same name from the lexer to codegen.
+    // Never freed: symbols and the views name() returns stay valid until the process exits,
+    // static destructors and threads still running included
+    inline Interner& symbols() {
+        static Interner* interner = new Interner();
+        return *interner;
+    }
+
+    // Per-parser front of the global interner. Names it has seen resolve without touching
+    // the shared lock, a new name goes through the global table once per cache
+    class SymbolCache {
+    private:
+        unordered_map<string_view, Symbol> known; // Views into the global interner, which is never freed
+
+    public:
+        Symbol intern(string_view name) {
+            auto it = this->known.find(name);
+            if (it != this->known.end()) return it->second;
+
+            Symbol symbol = symbols().intern(name);
+            this->known.emplace(symbols().name(symbol), symbol);
+            return symbol;
+        }
+    };
+
+    inline string symbolName(Symbol symbol) {
+        return string(symbols().name(symbol));
+    }
+
+}
@@ -0,0 +1,81 @@
+/***
+ * @file bytecode.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "bytecode.hpp"
+#include <array>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    static const array<const char*, VmOpCount> OpNames = {{
+        #define SOLAR_VM_NAME(name) #name,
+        SOLAR_VM_OPS(SOLAR_VM_NAME)
+        #undef SOLAR_VM_NAME
+    }};
+
+    const char* opName(Op op) {
+        auto index = static_cast<size_t>(op);
+        return index < VmOpCount ? OpNames[index] : "?";
+    }
+
+    string Program::disassemble() const {
+        string result;
+
+        for (size_t index = 0; index < this->functions.size(); index++) {
+            const auto& function = this->functions[index];
+            result += "function " + to_string(index) + " " + function.name + " (params " + to_string(function.params) +
+                ", registers " + to_string(function.registers) + ")\n";
+
+            for (size_t pc = 0; pc < function.code.size(); pc++) {
+                Instruction ins = function.code[pc];
+                Op op = decodeOp(ins);
+                result += "  " + to_string(pc) + "\t" + opName(op) + "\t";
+
+                switch (op) {
+                    case Op::LoadI:
+                        result += to_string(decodeA(ins)) + " " + to_string(decodeSBx(ins));
+                        break;
+                    case Op::LoadK:
+                    case Op::GetGlobal:
+                    case Op::SetGlobal:
+                    case Op::Call:
+                        result += to_string(decodeA(ins)) + " " + to_string(decodeBx(ins));
+                        break;
+                    case Op::Move:
+                    case Op::NegI:
+                    case Op::NegD:
+                    case Op::NotI:
+                    case Op::NotB:
+                    case Op::Narrow8:
+                    case Op::Narrow1:
+                        result += to_string(decodeA(ins)) + " " + to_string(decodeB(ins));
+                        break;
+                    case Op::Ret:
+                        result += to_string(decodeA(ins));
+                        break;
+                    case Op::RetNull:
+                        break;
+
+                    default:
+                        result += to_string(decodeA(ins)) + " " + to_string(decodeB(ins)) + " " + to_string(decodeC(ins));
+                        break;
+                }
+
+                result += "\n";
+            }
+        }
+
+        return result;
+    }
+
+}
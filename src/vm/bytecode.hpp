@@ -0,0 +1,111 @@
+/***
+ * @file bytecode.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "ast/types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Every instruction of the VM, in encoding order. The interpreter's dispatch table, the
+    // disassembler names and the Op enum are all generated from this list.
+    //
+    //   I  int, char and bool: 32-bit wrapping, kept sign-extended; char and bool results go
+    //      through Narrow8 / Narrow1 afterwards
+    //   F  float: computed in double and rounded back to float precision
+    //   D  double
+    //
+    // Comparisons of floats use the D forms, a rounded float is exact in a double
+    #define SOLAR_VM_OPS(X)                                                                     \
+        X(Move)      /* R[A] = R[B]                                                   */        \
+        X(LoadI)     /* R[A] = sBx                                                    */        \
+        X(LoadK)     /* R[A] = K[Bx]                                                  */        \
+        X(GetGlobal) /* R[A] = G[Bx]                                                  */        \
+        X(SetGlobal) /* G[Bx] = R[A]                                                  */        \
+        X(AddI) X(SubI) X(MulI) X(DivI) X(ModI) X(PowI) /* R[A] = R[B] op R[C]        */        \
+        X(AddF) X(SubF) X(MulF) X(DivF) X(ModF) X(PowF)                                         \
+        X(AddD) X(SubD) X(MulD) X(DivD) X(ModD) X(PowD)                                         \
+        X(And) X(Or)                                                                            \
+        X(EqI) X(NeI) X(LtI) X(LeI) X(GtI) X(GeI)                                               \
+        X(EqD) X(NeD) X(LtD) X(LeD) X(GtD) X(GeD)                                               \
+        X(NegI) X(NegD) X(NotI) X(NotB) /* R[A] = op R[B]                             */        \
+        X(Narrow8)   /* R[A] = int8_t(R[B])                                           */        \
+        X(Narrow1)   /* R[A] = R[B] & 1                                               */        \
+        X(Call)      /* Calls function Bx, its arguments from R[A] up; result in R[A] */        \
+        X(Ret)       /* Returns R[A]                                                  */        \
+        X(RetNull)   /* Returns 0                                                     */
+
+    enum class Op : uint8_t {
+        #define SOLAR_VM_ENUM(name) name,
+        SOLAR_VM_OPS(SOLAR_VM_ENUM)
+        #undef SOLAR_VM_ENUM
+    };
+
+    constexpr size_t VmOpCount = static_cast<size_t>(Op::RetNull) + 1;
+
+    const char* opName(Op op);
+
+    // One register or constant, which member is live follows from the instruction reading it
+    union Value {
+        int64_t i;
+        double d;
+    };
+
+    // 32-bit instructions: op in the low byte, then A, then either B and C or a 16-bit Bx.
+    // sBx is Bx biased by 0x8000
+    using Instruction = uint32_t;
+
+    constexpr uint32_t MaxRegisters = 256;
+    constexpr uint32_t MaxIndex = 0xffff;
+    constexpr int32_t SBxBias = 0x8000;
+
+    inline Instruction encodeABC(Op op, uint32_t a, uint32_t b, uint32_t c) {
+        return static_cast<uint32_t>(op) | a << 8 | b << 16 | c << 24;
+    }
+
+    inline Instruction encodeABx(Op op, uint32_t a, uint32_t bx) {
+        return static_cast<uint32_t>(op) | a << 8 | bx << 16;
+    }
+
+    inline Op decodeOp(Instruction ins) { return static_cast<Op>(ins & 0xff); }
+    inline uint32_t decodeA(Instruction ins) { return (ins >> 8) & 0xff; }
+    inline uint32_t decodeB(Instruction ins) { return (ins >> 16) & 0xff; }
+    inline uint32_t decodeC(Instruction ins) { return ins >> 24; }
+    inline uint32_t decodeBx(Instruction ins) { return ins >> 16; }
+    inline int32_t decodeSBx(Instruction ins) { return static_cast<int32_t>(ins >> 16) - SBxBias; }
+
+    struct BytecodeFunction {
+        string name;
+        uint32_t params;
+        uint32_t registers; // Frame size, parameters first
+        TypeEnum returnKind;
+        vector<Instruction> code;
+    };
+
+    // Lowered file. `init` runs the top-level statements, top-level variables are the globals
+    struct Program {
+        vector<BytecodeFunction> functions;
+        vector<Value> constants;
+        uint32_t globals = 0;
+        uint32_t init = 0;
+        uint32_t main = UINT32_MAX; // UINT32_MAX without a main
+
+        string disassemble() const;
+    };
+
+}
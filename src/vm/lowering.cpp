@@ -0,0 +1,442 @@
+/***
+ * @file lowering.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "lowering.hpp"
+#include "parallel.hpp"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Instruction for every OpCode, indexed by it, per operand class. Float comparisons use
+    // the double forms; Not on bools is special cased to NotB
+    struct OpSelection {
+        Op integer;
+        Op floating;
+        Op doubled;
+    };
+
+    static const array<OpSelection, OpCodeCount> OpSelections = {{
+        /* Add */ {Op::AddI, Op::AddF, Op::AddD},
+        /* Sub */ {Op::SubI, Op::SubF, Op::SubD},
+        /* Mul */ {Op::MulI, Op::MulF, Op::MulD},
+        /* Div */ {Op::DivI, Op::DivF, Op::DivD},
+        /* Mod */ {Op::ModI, Op::ModF, Op::ModD},
+        /* Pow */ {Op::PowI, Op::PowF, Op::PowD},
+
+        /* And */ {Op::And, Op::And, Op::And},
+        /* Or  */ {Op::Or, Op::Or, Op::Or},
+
+        // Bools sit in registers as 0 and 1, so the int compares order false before true as the JIT does
+        /* Eq */ {Op::EqI, Op::EqD, Op::EqD},
+        /* Ne */ {Op::NeI, Op::NeD, Op::NeD},
+        /* Lt */ {Op::LtI, Op::LtD, Op::LtD},
+        /* Le */ {Op::LeI, Op::LeD, Op::LeD},
+        /* Gt */ {Op::GtI, Op::GtD, Op::GtD},
+        /* Ge */ {Op::GeI, Op::GeD, Op::GeD},
+
+        /* Neg */ {Op::NegI, Op::NegD, Op::NegD},
+        /* Not */ {Op::NotI, Op::NotI, Op::NotI},
+    }};
+
+    // Helpers //
+    static TypeEnum kindOf(const FlatAst& ast, NodeId node) {
+        return typeTable().kind(ast.types[node]);
+    }
+
+    static Op selectOp(OpCode op, TypeEnum kind) {
+        const OpSelection& selection = OpSelections[static_cast<size_t>(op)];
+
+        if (kind == TypeEnum::Double) return selection.doubled;
+        if (kind == TypeEnum::Float) return selection.floating;
+        return op == OpCode::Not && kind == TypeEnum::Bool ? Op::NotB : selection.integer;
+    }
+
+    // Whether evaluating `node` may write a local, which an operand read by register would miss
+    static bool hasAssignment(const FlatAst& ast, NodeId node) {
+        if (ast.kinds[node] == NodeType::AssignmentExpr) return true;
+
+        for (NodeId child : ast.getChildren(node)) {
+            if (hasAssignment(ast, child)) return true;
+        }
+
+        return false;
+    }
+
+    void BytecodeCompiler::emit(Instruction ins) {
+        this->function->code.push_back(ins);
+    }
+
+    uint32_t BytecodeCompiler::allocRegister() {
+        if (this->nextRegister == MaxRegisters) {
+            throw runtime_error("Function " + this->function->name + " needs more than " + to_string(MaxRegisters) + " registers");
+        }
+
+        uint32_t reg = this->nextRegister++;
+        this->function->registers = max(this->function->registers, this->nextRegister);
+        return reg;
+    }
+
+    uint32_t BytecodeCompiler::constant(Value value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        auto [it, added] = this->constantIds.emplace(bits, static_cast<uint32_t>(this->program.constants.size()));
+        if (added) {
+            if (it->second > MaxIndex) throw runtime_error("Too many constants for the bytecode backend");
+            this->program.constants.push_back(value);
+        }
+
+        return it->second;
+    }
+
+    bool BytecodeCompiler::isInit() const {
+        return this->function == &this->program.functions[this->program.init];
+    }
+
+    Program BytecodeCompiler::compile(const FlatAst& ast) {
+        this->ast = &ast;
+        this->program = Program();
+        this->functionIds.clear();
+        this->globalIds.clear();
+        this->constantIds.clear();
+
+        // Functions and globals are numbered first, a body may use one declared after it
+        auto topLevel = ast.getChildren(ast.root);
+        for (NodeId stmt : topLevel) {
+            Symbol name = ast.names[stmt];
+
+            if (ast.kinds[stmt] == NodeType::FuncStmt) {
+                auto params = static_cast<uint32_t>(ast.paramsEnd(stmt) - ast.paramsBegin(stmt));
+                this->functionIds[name] = static_cast<uint32_t>(this->program.functions.size());
+                this->program.functions.push_back({symbolName(name), params, 0, kindOf(ast, stmt), {}});
+            } else if (ast.kinds[stmt] == NodeType::VarDecStmt) {
+                this->globalIds.emplace(name, this->program.globals++);
+            }
+        }
+
+        if (this->program.functions.size() >= MaxIndex || this->program.globals > MaxIndex) {
+            throw runtime_error("Too many functions or globals for the bytecode backend");
+        }
+
+        this->program.init = static_cast<uint32_t>(this->program.functions.size());
+        this->program.functions.push_back({"<init>", 0, 0, TypeEnum::Null, {}});
+
+        static const Symbol mainName = symbols().intern("main");
+        auto mainIt = this->functionIds.find(mainName);
+        if (mainIt != this->functionIds.end()) this->program.main = mainIt->second;
+
+        for (NodeId stmt : topLevel) {
+            if (ast.kinds[stmt] == NodeType::FuncStmt) this->visitFunc(stmt, this->functionIds[ast.names[stmt]]);
+        }
+
+        // Everything else runs in order before main
+        this->function = &this->program.functions[this->program.init];
+        this->locals.clear();
+        this->nextRegister = 0;
+
+        for (NodeId stmt : topLevel) {
+            if (ast.kinds[stmt] != NodeType::FuncStmt) this->visitStmt(stmt);
+        }
+        this->emit(encodeABC(Op::RetNull, 0, 0, 0));
+
+        this->function = nullptr;
+        this->ast = nullptr;
+        return move(this->program);
+    }
+
+    // Statments //
+    void BytecodeCompiler::visitFunc(NodeId node, uint32_t index) {
+        this->function = &this->program.functions[index];
+        this->locals.clear();
+        this->nextRegister = 0;
+
+        for (auto param = this->ast->paramsBegin(node); param != this->ast->paramsEnd(node); ++param) {
+            this->locals[param->name] = this->allocRegister();
+        }
+
+        for (NodeId stmt : this->ast->getChildren(node)) {
+            this->visitStmt(stmt);
+        }
+
+        auto& code = this->function->code;
+        if (code.empty() || (decodeOp(code.back()) != Op::Ret && decodeOp(code.back()) != Op::RetNull)) {
+            this->emit(encodeABC(Op::RetNull, 0, 0, 0));
+        }
+    }
+
+    void BytecodeCompiler::visitStmt(NodeId node) {
+        uint32_t mark = this->nextRegister;
+
+        switch (this->ast->kinds[node]) {
+            case NodeType::FuncStmt:
+                throw runtime_error("The bytecode backend has no nested functions: " + symbolName(this->ast->names[node]));
+            case NodeType::BlockStmt: {
+                // Locals of the block go out of scope with it, their registers are reused
+                auto outer = this->locals;
+                for (NodeId stmt : this->ast->getChildren(node)) this->visitStmt(stmt);
+                this->locals = move(outer);
+                break;
+            }
+            case NodeType::ReturnStmt:
+                this->visitReturn(node);
+                break;
+            case NodeType::VarDecStmt:
+                this->visitVarDecl(node);
+                if (!this->isInit()) return; // A local keeps its register
+                break;
+            case NodeType::AssignmentExpr:
+                this->visitAssignExpr(node, MaxRegisters);
+                break;
+
+            default:
+                this->visitExpr(node, this->allocRegister());
+                break;
+        }
+
+        this->nextRegister = mark;
+    }
+
+    void BytecodeCompiler::visitReturn(NodeId node) {
+        NodeId ret = this->ast->getChild(node);
+
+        if (ret == InvalidNode || this->ast->kinds[ret] == NodeType::NullExpr) {
+            this->emit(encodeABC(Op::RetNull, 0, 0, 0));
+            return;
+        }
+
+        this->emit(encodeABC(Op::Ret, this->operand(ret), 0, 0));
+    }
+
+    void BytecodeCompiler::visitVarDecl(NodeId node) {
+        Symbol identifier = this->ast->names[node];
+        NodeId valueNode = this->ast->getChild(node);
+
+        // Top-level variables are globals, every function sees them
+        if (this->isInit()) {
+            uint32_t value = valueNode != InvalidNode ? this->operand(valueNode) : this->allocRegister();
+            if (valueNode == InvalidNode) this->emit(encodeABx(Op::LoadI, value, SBxBias));
+
+            this->emit(encodeABx(Op::SetGlobal, value, this->globalIds.at(identifier)));
+            return;
+        }
+
+        // The register is taken before the value is lowered, the value's temporaries go above it
+        uint32_t reg = this->allocRegister();
+
+        if (valueNode != InvalidNode) {
+            this->visitExpr(valueNode, reg);
+        } else {
+            this->emit(encodeABx(Op::LoadI, reg, SBxBias));
+        }
+
+        this->locals[identifier] = reg;
+        this->nextRegister = reg + 1;
+    }
+
+    // Expressions //
+    uint32_t BytecodeCompiler::operand(NodeId node, bool copy) {
+        if (!copy && this->ast->kinds[node] == NodeType::IdentExpr) {
+            auto local = this->locals.find(this->ast->names[node]);
+            if (local != this->locals.end()) return local->second;
+        }
+
+        uint32_t reg = this->allocRegister();
+        this->visitExpr(node, reg);
+        return reg;
+    }
+
+    void BytecodeCompiler::visitExpr(NodeId node, uint32_t target) {
+        switch (this->ast->kinds[node]) {
+            case NodeType::AssignmentExpr:
+                this->visitAssignExpr(node, target);
+                break;
+            case NodeType::CallExpr:
+                this->visitCallExpr(node, target);
+                break;
+            case NodeType::BinaryExpr:
+            case NodeType::LogicalExpr:
+            case NodeType::ComparasonExpr:
+                this->visitBinaryExpr(node, target);
+                break;
+            case NodeType::UnaryExpr:
+                this->visitUnaryExpr(node, target);
+                break;
+
+            default:
+                this->visitPrimaryExpr(node, target);
+                break;
+        }
+    }
+
+    // `target` is MaxRegisters when the value is not used
+    void BytecodeCompiler::visitAssignExpr(NodeId node, uint32_t target) {
+        Symbol name = this->ast->names[node];
+        NodeId valueNode = this->ast->getChild(node);
+        uint32_t mark = this->nextRegister;
+
+        auto local = this->locals.find(name);
+        if (local != this->locals.end()) {
+            this->visitExpr(valueNode, local->second);
+            if (target != MaxRegisters && target != local->second) this->emit(encodeABC(Op::Move, target, local->second, 0));
+        } else {
+            auto global = this->globalIds.find(name);
+            if (global == this->globalIds.end()) throw runtime_error("Assignment to unknown variable: " + symbolName(name));
+
+            uint32_t value = target != MaxRegisters ? target : this->allocRegister();
+            this->visitExpr(valueNode, value);
+            this->emit(encodeABx(Op::SetGlobal, value, global->second));
+        }
+
+        this->nextRegister = mark;
+    }
+
+    void BytecodeCompiler::visitCallExpr(NodeId node, uint32_t target) {
+        if (this->ast->payloads[node]) throw runtime_error("The bytecode backend can't call an expression");
+
+        auto nodeChildren = this->ast->getChildren(node);
+        Symbol callee = this->ast->names[nodeChildren[0]];
+
+        auto it = this->functionIds.find(callee);
+        if (it == this->functionIds.end()) throw runtime_error("Call to unknown function: " + symbolName(callee));
+
+        // Arguments go in a row from `base`, where the callee's frame starts; the result lands in its first register
+        uint32_t mark = this->nextRegister;
+        uint32_t base = this->allocRegister();
+
+        for (size_t i = 1; i < nodeChildren.size(); i++) {
+            uint32_t reg = i == 1 ? base : this->allocRegister();
+            this->visitExpr(nodeChildren[i], reg);
+        }
+
+        this->emit(encodeABx(Op::Call, base, it->second));
+        if (target != base) this->emit(encodeABC(Op::Move, target, base, 0));
+
+        this->nextRegister = mark;
+    }
+
+    void BytecodeCompiler::visitBinaryExpr(NodeId node, uint32_t target) {
+        NodeId leftNode = this->ast->getChild(node, 0);
+        NodeId rightNode = this->ast->getChild(node, 1);
+        OpCode op = this->ast->getOp(node);
+        TypeEnum kind = kindOf(*this->ast, leftNode);
+        uint32_t mark = this->nextRegister;
+
+        // A left local read by register would see an assignment made on the right
+        bool copy = this->ast->kinds[leftNode] == NodeType::IdentExpr && hasAssignment(*this->ast, rightNode);
+        uint32_t left = this->operand(leftNode, copy);
+        uint32_t right = this->operand(rightNode);
+        this->emit(encodeABC(selectOp(op, kind), target, left, right));
+
+        // Arithmetic on chars and bools wraps at their width
+        if (op <= OpCode::Pow && kind == TypeEnum::Char) this->emit(encodeABC(Op::Narrow8, target, target, 0));
+        if (op <= OpCode::Pow && kind == TypeEnum::Bool) this->emit(encodeABC(Op::Narrow1, target, target, 0));
+
+        this->nextRegister = mark;
+    }
+
+    void BytecodeCompiler::visitUnaryExpr(NodeId node, uint32_t target) {
+        NodeId valueNode = this->ast->getChild(node);
+        OpCode op = this->ast->getOp(node);
+        TypeEnum kind = kindOf(*this->ast, valueNode);
+        uint32_t mark = this->nextRegister;
+
+        this->emit(encodeABC(selectOp(op, kind), target, this->operand(valueNode), 0));
+
+        if (kind == TypeEnum::Char) this->emit(encodeABC(Op::Narrow8, target, target, 0));
+        if (op == OpCode::Neg && kind == TypeEnum::Bool) this->emit(encodeABC(Op::Narrow1, target, target, 0));
+
+        this->nextRegister = mark;
+    }
+
+    void BytecodeCompiler::visitPrimaryExpr(NodeId node, uint32_t target) {
+        Value value;
+
+        switch (this->ast->kinds[node]) {
+            case NodeType::NullExpr:
+            case NodeType::BoolExpr:
+            case NodeType::CharExpr:
+            case NodeType::IntExpr: {
+                int64_t number = 0;
+                if (this->ast->kinds[node] == NodeType::CharExpr) number = static_cast<int8_t>(this->ast->payloads[node]);
+                else if (this->ast->kinds[node] == NodeType::BoolExpr) number = this->ast->payloads[node] != 0;
+                else if (this->ast->kinds[node] == NodeType::IntExpr) number = static_cast<int32_t>(this->ast->payloads[node]);
+
+                // Small numbers ride in the instruction
+                if (number >= -SBxBias && number < SBxBias) {
+                    this->emit(encodeABx(Op::LoadI, target, static_cast<uint32_t>(number + SBxBias)));
+                    return;
+                }
+
+                value.i = number;
+                break;
+            }
+            case NodeType::DoubleExpr:
+                value.d = this->ast->getDouble(node);
+                break;
+            case NodeType::FloatExpr:
+                value.d = this->ast->getFloat(node);
+                break;
+            case NodeType::IdentExpr: {
+                Symbol name = this->ast->names[node];
+
+                auto local = this->locals.find(name);
+                if (local != this->locals.end()) {
+                    if (local->second != target) this->emit(encodeABC(Op::Move, target, local->second, 0));
+                    return;
+                }
+
+                auto global = this->globalIds.find(name);
+                if (global != this->globalIds.end()) {
+                    this->emit(encodeABx(Op::GetGlobal, target, global->second));
+                    return;
+                }
+
+                throw runtime_error("The bytecode backend can't use " + symbolName(name) + " as a value");
+            }
+
+            default:
+                throw runtime_error("The bytecode backend can't lower this expression");
+        }
+
+        this->emit(encodeABx(Op::LoadK, target, this->constant(value)));
+    }
+
+    Program compileBytecode(const SourceManager& sources, FileId file, const string& cacheDir) {
+        AstArena arena;
+        Solar::Parser parser(sources);
+        BlockStmt* block = nullptr;
+
+        // Same AST images as the LLVM backend, a hit skips lexing and parsing
+        if (!cacheDir.empty()) {
+            AstCache cache(cacheDir);
+            block = cache.load(sources, file, arena);
+
+            if (!block) {
+                block = parser.parseCode(file, arena, workerCount() > 1);
+                cache.store(sources, file, block);
+            }
+        } else {
+            block = parser.parseCode(file, arena, workerCount() > 1);
+        }
+
+        Sema sema(sources);
+        sema.check(block);
+
+        FlatAst ast(block);
+        return BytecodeCompiler().compile(ast);
+    }
+
+}
@@ -0,0 +1,72 @@
+/***
+ * @file lowering.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "bytecode.hpp"
+#include "ast/pack.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Lowers a checked tree to register bytecode. Parameters take the first registers of a
+    // frame, then every local its own register in declaration order, and temporaries are
+    // stacked above them and released once their statement is done
+    class BytecodeCompiler {
+    private:
+        const FlatAst* ast = nullptr;
+        Program program;
+        unordered_map<Symbol, uint32_t> functionIds;
+        unordered_map<Symbol, uint32_t> globalIds;
+        unordered_map<uint64_t, uint32_t> constantIds; // By bit pattern
+
+        // Function being lowered //
+        BytecodeFunction* function = nullptr;
+        unordered_map<Symbol, uint32_t> locals;
+        uint32_t nextRegister = 0;
+
+        void emit(Instruction ins);
+        uint32_t allocRegister();
+        uint32_t constant(Value value);
+        bool isInit() const;
+
+        // Statments //
+        void visitFunc(NodeId node, uint32_t index);
+        void visitStmt(NodeId node);
+        void visitReturn(NodeId node);
+        void visitVarDecl(NodeId node);
+
+        // Expressions //
+        uint32_t operand(NodeId node, bool copy = false);
+        void visitExpr(NodeId node, uint32_t target);
+
+        void visitAssignExpr(NodeId node, uint32_t target);
+        void visitCallExpr(NodeId node, uint32_t target);
+        void visitBinaryExpr(NodeId node, uint32_t target);
+        void visitUnaryExpr(NodeId node, uint32_t target);
+        void visitPrimaryExpr(NodeId node, uint32_t target);
+
+    public:
+        // Throws on what the bytecode can't express: calls through expressions, nested
+        // functions and functions used as values
+        Program compile(const FlatAst& ast);
+    };
+
+    // Parses, checks and lowers `file`; errors are reported and thrown like in the LLVM backend.
+    // With `cacheDir`, the tree is loaded from and stored to its AstCache
+    Program compileBytecode(const SourceManager& sources, FileId file, const string& cacheDir = "");
+
+}
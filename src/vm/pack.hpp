@@ -0,0 +1,5 @@
+#pragma once
+
+#include "bytecode.hpp"
+#include "lowering.hpp"
+#include "vm.hpp"
\ No newline at end of file
@@ -0,0 +1,240 @@
+/***
+ * @file vm.cpp
+ */
+
+//////////////
+// Includes //
+//////////////
+
+#include "vm.hpp"
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+// Labels as values are a GNU extension, gcc and clang both have them
+#if defined(__GNUC__)
+    #define SOLAR_VM_THREADED 1
+#else
+    #define SOLAR_VM_THREADED 0
+#endif
+
+namespace Solar {
+
+    // Helpers //
+    static inline int64_t wrap32(uint32_t value) {
+        return static_cast<int32_t>(value);
+    }
+
+    static inline double roundFloat(double value) {
+        return static_cast<float>(value);
+    }
+
+    // fptosi of an out of range value, as x86 gives it
+    static inline int64_t toInt32(double value) {
+        return value >= -2147483648.0 && value < 2147483648.0 ? static_cast<int32_t>(value) : INT32_MIN;
+    }
+
+    // Initializers //
+    // The stack is left uninitialized, every register is written before it is read
+    VM::VM(size_t stackSize) : stack(new Value[stackSize]), stackSize(stackSize) {
+        this->frames.reserve(64);
+    }
+
+    int VM::runMain(const Program& program) {
+        if (program.main == UINT32_MAX) throw runtime_error("Nothing to run, there is no main function");
+
+        const auto& mainFunc = program.functions[program.main];
+        TypeEnum kind = mainFunc.returnKind;
+        if (mainFunc.params != 0 || !(kind == TypeEnum::Null || kind == TypeEnum::Int || kind == TypeEnum::Char || kind == TypeEnum::Bool)) {
+            throw runtime_error("main must take no arguments and return int, char, bool or null to be run");
+        }
+
+        Value zero;
+        zero.i = 0;
+        this->globals.assign(program.globals, zero);
+        this->frames.clear();
+
+        this->execute(program, program.init);
+        Value result = this->execute(program, program.main);
+
+        return kind == TypeEnum::Null ? 0 : static_cast<int>(result.i);
+    }
+
+    // Interpreter //
+
+    // Taking label addresses and `goto *` are what -Wpedantic reports here
+#if SOLAR_VM_THREADED
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+    Value VM::execute(const Program& program, uint32_t entry) {
+        const BytecodeFunction* function = &program.functions[entry];
+        const Instruction* pc = function->code.data();
+        const Value* constants = program.constants.data();
+        Value* globals = this->globals.data();
+        Value* registers = this->stack.get();
+        Value* stackEnd = registers + this->stackSize;
+        const size_t baseDepth = this->frames.size();
+        Instruction ins;
+
+        if (function->registers > this->stackSize) throw runtime_error("Stack overflow calling " + function->name);
+
+        #define VM_A decodeA(ins)
+        #define VM_B decodeB(ins)
+        #define VM_C decodeC(ins)
+        #define VM_BX decodeBx(ins)
+        #define VM_RA registers[VM_A]
+        #define VM_RB registers[VM_B]
+        #define VM_RC registers[VM_C]
+
+#if SOLAR_VM_THREADED
+        static const void* const labels[VmOpCount] = {
+            #define SOLAR_VM_LABEL(name) &&op_##name,
+            SOLAR_VM_OPS(SOLAR_VM_LABEL)
+            #undef SOLAR_VM_LABEL
+        };
+
+        #define VM_CASE(name) op_##name:
+        #define VM_NEXT() do { ins = *pc++; goto *labels[ins & 0xff]; } while (0)
+
+        VM_NEXT();
+#else
+        #define VM_CASE(name) case Op::name:
+        #define VM_NEXT() continue
+
+        for (;;) {
+            ins = *pc++;
+            switch (decodeOp(ins)) {
+#endif
+
+        VM_CASE(Move) VM_RA = VM_RB; VM_NEXT();
+        VM_CASE(LoadI) VM_RA.i = decodeSBx(ins); VM_NEXT();
+        VM_CASE(LoadK) VM_RA = constants[VM_BX]; VM_NEXT();
+        VM_CASE(GetGlobal) VM_RA = globals[VM_BX]; VM_NEXT();
+        VM_CASE(SetGlobal) globals[VM_BX] = VM_RA; VM_NEXT();
+
+        VM_CASE(AddI) VM_RA.i = wrap32(static_cast<uint32_t>(VM_RB.i) + static_cast<uint32_t>(VM_RC.i)); VM_NEXT();
+        VM_CASE(SubI) VM_RA.i = wrap32(static_cast<uint32_t>(VM_RB.i) - static_cast<uint32_t>(VM_RC.i)); VM_NEXT();
+        VM_CASE(MulI) VM_RA.i = wrap32(static_cast<uint32_t>(VM_RB.i) * static_cast<uint32_t>(VM_RC.i)); VM_NEXT();
+        VM_CASE(DivI) {
+            int64_t divisor = VM_RC.i;
+            if (divisor == 0) throw runtime_error("Division by zero in " + function->name);
+
+            // INT_MIN / -1 wraps instead of trapping
+            VM_RA.i = divisor == -1 ? wrap32(0u - static_cast<uint32_t>(VM_RB.i)) : VM_RB.i / divisor;
+            VM_NEXT();
+        }
+        VM_CASE(ModI) {
+            int64_t divisor = VM_RC.i;
+            if (divisor == 0) throw runtime_error("Division by zero in " + function->name);
+
+            VM_RA.i = divisor == -1 ? 0 : VM_RB.i % divisor;
+            VM_NEXT();
+        }
+        VM_CASE(PowI) VM_RA.i = toInt32(pow(static_cast<double>(VM_RB.i), static_cast<double>(VM_RC.i))); VM_NEXT();
+
+        VM_CASE(AddF) VM_RA.d = roundFloat(VM_RB.d + VM_RC.d); VM_NEXT();
+        VM_CASE(SubF) VM_RA.d = roundFloat(VM_RB.d - VM_RC.d); VM_NEXT();
+        VM_CASE(MulF) VM_RA.d = roundFloat(VM_RB.d * VM_RC.d); VM_NEXT();
+        VM_CASE(DivF) VM_RA.d = roundFloat(VM_RB.d / VM_RC.d); VM_NEXT();
+        VM_CASE(ModF) VM_RA.d = fmodf(static_cast<float>(VM_RB.d), static_cast<float>(VM_RC.d)); VM_NEXT();
+        VM_CASE(PowF) VM_RA.d = powf(static_cast<float>(VM_RB.d), static_cast<float>(VM_RC.d)); VM_NEXT();
+
+        VM_CASE(AddD) VM_RA.d = VM_RB.d + VM_RC.d; VM_NEXT();
+        VM_CASE(SubD) VM_RA.d = VM_RB.d - VM_RC.d; VM_NEXT();
+        VM_CASE(MulD) VM_RA.d = VM_RB.d * VM_RC.d; VM_NEXT();
+        VM_CASE(DivD) VM_RA.d = VM_RB.d / VM_RC.d; VM_NEXT();
+        VM_CASE(ModD) VM_RA.d = fmod(VM_RB.d, VM_RC.d); VM_NEXT();
+        VM_CASE(PowD) VM_RA.d = pow(VM_RB.d, VM_RC.d); VM_NEXT();
+
+        VM_CASE(And) VM_RA.i = VM_RB.i & VM_RC.i; VM_NEXT();
+        VM_CASE(Or) VM_RA.i = VM_RB.i | VM_RC.i; VM_NEXT();
+
+        VM_CASE(EqI) VM_RA.i = VM_RB.i == VM_RC.i; VM_NEXT();
+        VM_CASE(NeI) VM_RA.i = VM_RB.i != VM_RC.i; VM_NEXT();
+        VM_CASE(LtI) VM_RA.i = VM_RB.i < VM_RC.i; VM_NEXT();
+        VM_CASE(LeI) VM_RA.i = VM_RB.i <= VM_RC.i; VM_NEXT();
+        VM_CASE(GtI) VM_RA.i = VM_RB.i > VM_RC.i; VM_NEXT();
+        VM_CASE(GeI) VM_RA.i = VM_RB.i >= VM_RC.i; VM_NEXT();
+
+        // Ordered comparisons, except Ne which is true on NaN like fcmp une
+        VM_CASE(EqD) VM_RA.i = VM_RB.d == VM_RC.d; VM_NEXT();
+        VM_CASE(NeD) VM_RA.i = !(VM_RB.d == VM_RC.d); VM_NEXT();
+        VM_CASE(LtD) VM_RA.i = VM_RB.d < VM_RC.d; VM_NEXT();
+        VM_CASE(LeD) VM_RA.i = VM_RB.d <= VM_RC.d; VM_NEXT();
+        VM_CASE(GtD) VM_RA.i = VM_RB.d > VM_RC.d; VM_NEXT();
+        VM_CASE(GeD) VM_RA.i = VM_RB.d >= VM_RC.d; VM_NEXT();
+
+        VM_CASE(NegI) VM_RA.i = wrap32(0u - static_cast<uint32_t>(VM_RB.i)); VM_NEXT();
+        VM_CASE(NegD) VM_RA.d = -VM_RB.d; VM_NEXT();
+        VM_CASE(NotI) VM_RA.i = ~VM_RB.i; VM_NEXT();
+        VM_CASE(NotB) VM_RA.i = VM_RB.i ^ 1; VM_NEXT();
+        VM_CASE(Narrow8) VM_RA.i = static_cast<int8_t>(VM_RB.i); VM_NEXT();
+        VM_CASE(Narrow1) VM_RA.i = VM_RB.i & 1; VM_NEXT();
+
+        VM_CASE(Call) {
+            const BytecodeFunction* callee = &program.functions[VM_BX];
+            Value* calleeRegisters = registers + VM_A;
+
+            if (calleeRegisters + callee->registers > stackEnd) throw runtime_error("Stack overflow calling " + callee->name);
+
+            this->frames.push_back({function, pc, registers});
+            function = callee;
+            pc = callee->code.data();
+            registers = calleeRegisters;
+            VM_NEXT();
+        }
+
+        // The callee's first register is the caller's call register, the result is left there
+        VM_CASE(Ret) {
+            registers[0] = VM_RA;
+            if (this->frames.size() == baseDepth) return registers[0];
+
+            const Frame& caller = this->frames.back();
+            function = caller.function;
+            pc = caller.pc;
+            registers = caller.registers;
+            this->frames.pop_back();
+            VM_NEXT();
+        }
+        VM_CASE(RetNull) {
+            registers[0].i = 0;
+            if (this->frames.size() == baseDepth) return registers[0];
+
+            const Frame& caller = this->frames.back();
+            function = caller.function;
+            pc = caller.pc;
+            registers = caller.registers;
+            this->frames.pop_back();
+            VM_NEXT();
+        }
+
+#if !SOLAR_VM_THREADED
+            }
+        }
+#endif
+
+        #undef VM_CASE
+        #undef VM_NEXT
+        #undef VM_A
+        #undef VM_B
+        #undef VM_C
+        #undef VM_BX
+        #undef VM_RA
+        #undef VM_RB
+        #undef VM_RC
+    }
+
+#if SOLAR_VM_THREADED
+    #pragma GCC diagnostic pop
+#endif
+
+}
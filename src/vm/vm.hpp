@@ -0,0 +1,51 @@
+/***
+ * @file vm.hpp
+ */
+
+#pragma once
+
+//////////////
+// Includes //
+//////////////
+
+#include "bytecode.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+//////////
+// Code //
+//////////
+
+namespace Solar {
+
+    // Register machine running a lowered Program. Frames are windows on one value stack: a
+    // call's arguments already sit where the callee's first registers are, so nothing is copied.
+    // Dispatch is threaded through computed gotos where the compiler has them, a switch otherwise
+    class VM {
+    private:
+        struct Frame {
+            const BytecodeFunction* function;
+            const Instruction* pc;
+            Value* registers;
+        };
+
+        unique_ptr<Value[]> stack;
+        size_t stackSize;
+        vector<Value> globals;
+        vector<Frame> frames;
+
+        Value execute(const Program& program, uint32_t entry);
+
+    public:
+        // `stackSize` values bound the depth of the calls, running past them throws
+        explicit VM(size_t stackSize = 1 << 20);
+
+        // Runs the top-level statements and then main, returning what main returned. Throws when
+        // there is no main, it can't be run like in the JIT, or a division by zero or stack overflow
+        int runMain(const Program& program);
+    };
+
+}
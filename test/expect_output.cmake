@@ -0,0 +1,7 @@
+# Runs `${SOLAR} vm ${SOURCE}` and passes when its output matches ${EXPECT}, whatever the exit
+# code: errors abort the compiler
+execute_process(COMMAND ${SOLAR} vm ${SOURCE} OUTPUT_VARIABLE output ERROR_VARIABLE output)
+
+if (NOT output MATCHES "${EXPECT}")
+    message(FATAL_ERROR "Expected \"${EXPECT}\" from ${SOURCE}, got:\n${output}")
+endif()